@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TD_BENCH_H
+#define TD_BENCH_H
+
+#include <map.h>
+#include <blt/std/types.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace td::bench
+{
+	// runs func iterations times and returns the average time of a single call in nanoseconds
+	template <typename Func>
+	double time_ns(const blt::size_t iterations, Func&& func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (blt::size_t i = 0; i < iterations; ++i)
+			func();
+		const auto end = std::chrono::steady_clock::now();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		return static_cast<double>(elapsed) / static_cast<double>(iterations);
+	}
+
+	// runs func in growing batches until a batch takes at least min_seconds, returns the average time of a single call in that batch.
+	// for benchmarks where a fixed iteration count would be too short to time on fast machines or too long on slow ones.
+	template <typename Func>
+	double time_auto_ns(Func&& func, const double min_seconds = 0.2)
+	{
+		blt::size_t iterations = 1;
+		while (true)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (blt::size_t i = 0; i < iterations; ++i)
+				func();
+			const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (elapsed >= min_seconds || iterations >= (1ull << 32))
+				return elapsed * 1e9 / static_cast<double>(iterations);
+			// aim a little past the target so the next batch is usually the last
+			iterations = elapsed <= 0 ? iterations * 10 : static_cast<blt::size_t>(static_cast<double>(iterations) * min_seconds * 1.2 / elapsed) + 1;
+		}
+	}
+
+	struct result_t
+	{
+		std::string name;
+		double ns_per_op;
+		blt::size_t items;
+		double items_per_second;
+	};
+
+	// items is the number of elements processed by a single call, used to report throughput.
+	// every reported result is also kept for the JSON output.
+	void report(const std::string& name, double ns_per_op, blt::size_t items);
+
+	[[nodiscard]] const std::vector<result_t>& get_results();
+
+	// a wandering path of segment_count curves, the same for the same seed
+	[[nodiscard]] std::vector<path_segment_t> make_random_path(blt::size_t segment_count, blt::u32 seed);
+
+	void run_enemy_store();
+
+	void run_bounding_box();
+
+	void run_spatial_grid();
+
+	void run_enemy_database();
+
+	void run_path();
+
+	void run_map();
+
+	void run_targeting();
+
+	void run_projectiles();
+
+	void run_particles();
+
+	void run_resource_loader();
+}
+
+#endif //TD_BENCH_H
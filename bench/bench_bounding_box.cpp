@@ -0,0 +1,89 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <map.h>
+#include <blt/std/utility.h>
+#include <random>
+
+namespace td::bench
+{
+	void run_bounding_box()
+	{
+		constexpr blt::size_t segment_count = 1024;
+		constexpr blt::size_t query_count = 4096;
+		constexpr blt::size_t iterations = 50;
+
+		// a long wandering path, the kind of layout where most queries only touch a few segments
+		const auto segments = make_random_path(segment_count, 42);
+		std::mt19937 random{42};
+		std::uniform_real_distribution<float> world{0, 2000};
+
+		std::vector<bounding_box_t> boxes;
+		boxes.reserve(segments.size());
+		for (const auto& segment : segments)
+			boxes.push_back(segment.get_bounding_box());
+
+		std::vector<blt::vec2> points;
+		points.reserve(query_count);
+		for (blt::size_t i = 0; i < query_count; ++i)
+			points.emplace_back(world(random), world(random));
+
+		std::vector<blt::u32> results;
+		report("path_segment_t::get_bounding_box brute force contains", time_ns(iterations, [&]() {
+			results.clear();
+			for (const auto& p : points)
+			{
+				for (blt::size_t i = 0; i < segments.size(); ++i)
+				{
+					if (segments[i].get_bounding_box().contains(p))
+						results.push_back(static_cast<blt::u32>(i));
+				}
+			}
+		}), query_count);
+
+		report("b_box_hierarchy_t::build (1024 boxes)", time_ns(iterations, [&]() {
+			const b_box_hierarchy_t hierarchy{boxes};
+			blt::black_box(hierarchy);
+		}), boxes.size());
+
+		const b_box_hierarchy_t hierarchy{boxes};
+		std::vector<blt::u32> offsets;
+		report("b_box_hierarchy_t::contains (batched)", time_ns(iterations, [&]() {
+			hierarchy.contains(points.data(), points.size(), offsets, results);
+		}), query_count);
+
+		std::vector<bounding_box_t> query_boxes;
+		query_boxes.reserve(query_count);
+		for (const auto& p : points)
+			query_boxes.emplace_back(p, blt::vec2{p.x() + 50, p.y() + 50});
+		report("path_segment_t::get_bounding_box brute force intersects", time_ns(iterations, [&]() {
+			results.clear();
+			for (const auto& box : query_boxes)
+			{
+				for (blt::size_t i = 0; i < segments.size(); ++i)
+				{
+					if (segments[i].get_bounding_box().intersects(box))
+						results.push_back(static_cast<blt::u32>(i));
+				}
+			}
+		}), query_count);
+		report("b_box_hierarchy_t::intersections (batched)", time_ns(iterations, [&]() {
+			hierarchy.intersections(query_boxes.data(), query_boxes.size(), offsets, results);
+		}), query_count);
+	}
+}
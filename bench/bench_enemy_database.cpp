@@ -0,0 +1,55 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <enemies.h>
+#include <filesystem>
+#include <fstream>
+
+namespace td::bench
+{
+	void run_enemy_database()
+	{
+		// a definition file of a realistic size. There are only a few enemy ids so most lines redefine an earlier enemy,
+		// the text loader still has to parse and validate every one of them.
+		constexpr blt::size_t line_count = 2048;
+		constexpr blt::size_t iterations = 200;
+		const auto directory = std::filesystem::temp_directory_path();
+		const auto text_path = (directory / "td_bench_enemies.txt").string();
+		const auto binary_path = (directory / "td_bench_enemies.bin").string();
+		{
+			std::ofstream text{text_path};
+			for (blt::size_t i = 0; i < line_count; ++i)
+				text << (i % 2 == 0 ? "TEST" : "TEST_SPLITTER") << " texture_" << i % 64 << " " << 1 + i % 7 << " 1 " << 5 + i % 11
+					<< " WAG_TAIL|HUGS TEST TEST_SPLITTER\n";
+		}
+		enemy_database_t compiled;
+		compiled.load_text(text_path);
+		compiled.write_binary(binary_path);
+
+		enemy_database_t database;
+		report("enemy_database_t::load_text", time_ns(iterations, [&database, &text_path]() {
+			database.load_text(text_path);
+		}), line_count);
+		report("enemy_database_t::load_binary", time_ns(iterations, [&database, &binary_path]() {
+			database.load_binary(binary_path);
+		}), database.get_enemy_count());
+
+		std::filesystem::remove(text_path);
+		std::filesystem::remove(binary_path);
+	}
+}
@@ -0,0 +1,65 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <enemy_store.h>
+
+namespace td::bench
+{
+	void run_enemy_store()
+	{
+		constexpr blt::size_t wave_size = 50000;
+		constexpr blt::size_t survivors = 100;
+		constexpr blt::size_t iterations = 2000;
+		std::vector<blt::u32> crossed;
+
+		// a segment in the middle of a large wave, nothing crosses so the size stays constant
+		enemy_store_t full;
+		full.reserve(wave_size);
+		for (blt::size_t i = 0; i < wave_size; ++i)
+			full.add(enemy_instance_t{enemy_id_t::TEST, 1}, 0);
+		report("enemy_store_t::advance (50k live)", time_ns(iterations, [&]() {
+			crossed.clear();
+			full.advance(0.001f, 1.0f, crossed);
+		}), full.size());
+
+		// the same segment once the wave has drained. With tombstones this would still walk 50k slots,
+		// the dense pool only walks the survivors.
+		enemy_store_t drained;
+		drained.reserve(wave_size);
+		for (blt::size_t i = 0; i < wave_size; ++i)
+			drained.add(enemy_instance_t{enemy_id_t::TEST, 1}, i < survivors ? 0.0f : 1.0f);
+		crossed.clear();
+		drained.advance(1.0f, 1.0f, crossed);
+		drained.remove_sorted(crossed);
+		report("enemy_store_t::advance (50k drained to 100)", time_ns(iterations, [&]() {
+			crossed.clear();
+			drained.advance(0.001f, 1.0f, crossed);
+		}), drained.size());
+
+		// cost of draining the wave itself, one swap and pop per removed enemy
+		report("enemy_store_t::remove_sorted (50k)", time_ns(1, [&]() {
+			enemy_store_t store;
+			store.reserve(wave_size);
+			for (blt::size_t i = 0; i < wave_size; ++i)
+				store.add(enemy_instance_t{enemy_id_t::TEST, 1}, 1.0f);
+			std::vector<blt::u32> all;
+			store.advance(1.0f, 1.0f, all);
+			store.remove_sorted(all);
+		}), wave_size);
+	}
+}
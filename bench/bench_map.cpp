@@ -0,0 +1,59 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <map.h>
+#include <blt/std/utility.h>
+#include <string>
+
+namespace td::bench
+{
+	void run_map()
+	{
+		enemy_database_t database;
+
+		// the whole update: advance, leak handling, positions and the grid rebuild. Enemies are spread over the path and stepped by a
+		// tiny dt so none leak while timing and the count stays fixed.
+		for (const blt::size_t segment_count : {4, 64, 1024})
+		{
+			const auto segments = make_random_path(segment_count, 3);
+			for (const blt::size_t enemy_count : {1000, 10000, 100000})
+			{
+				map_t map{segments, database};
+				const auto total_length = map.get_total_length();
+				for (blt::size_t i = 0; i < enemy_count; ++i)
+					map.spawn(enemy_id_t::TEST, total_length * 0.9f * static_cast<float>(i) / static_cast<float>(enemy_count));
+				report("map_t::step (" + std::to_string(segment_count) + " segments, " + std::to_string(enemy_count) + " enemies)",
+						time_auto_ns([&map]() {
+							map.step(1e-6f);
+						}), enemy_count);
+			}
+		}
+
+		for (const blt::i32 draw_segments : {32, 128})
+		{
+			const auto segments = make_random_path(64, 3);
+			const map_t map{segments, database};
+			const auto previous = PATH_DRAW_SEGMENTS;
+			PATH_DRAW_SEGMENTS = draw_segments;
+			report("map_t::get_mesh_data (64 segments, " + std::to_string(draw_segments) + " draw segments)", time_auto_ns([&map]() {
+				blt::black_box(map.get_mesh_data(10));
+			}), 64);
+			PATH_DRAW_SEGMENTS = previous;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <particles.h>
+#include <blt/std/utility.h>
+#include <string>
+
+namespace td::bench
+{
+	void run_particles()
+	{
+		constexpr float frame = 1.0f / 60.0f;
+
+		for (const blt::size_t particle_count : {10000, 100000, 250000})
+		{
+			// lifetimes long enough that nothing dies while timing, so every frame works on the full count
+			particle_system_t system{particle_count, 7};
+			const particle_emitter_t emitter{static_cast<blt::u32>(particle_count), 40, 160, 1e6f, 2e6f, 4, 1, 0.3f, 0.4f};
+			system.emit(emitter, blt::vec2{500, 500});
+			std::vector<sprite_instance_t> instances;
+			instances.reserve(particle_count);
+			const auto name = std::to_string(particle_count) + " particles";
+
+			// a fixed ten seconds of frames. Drag keeps slowing the particles down, run long enough and their velocities become denormals,
+			// which no real particle lives long enough to reach.
+			report("particle_pool_t::step (" + name + ")", time_ns(600, [&system, frame]() {
+				system.step(frame);
+			}), particle_count);
+			report("particle_pool_t::write_instances (" + name + ")", time_auto_ns([&system, &instances]() {
+				instances.clear();
+				system.write_instances(instances);
+				blt::black_box(instances.data());
+			}), particle_count);
+		}
+
+		// emission into a full ring, every new particle recycles the oldest one
+		particle_system_t system{250000, 7};
+		const particle_emitter_t burst{24, 40, 160, 0.3f, 0.8f, 4, 1, 0.3f, 0.4f};
+		for (blt::size_t i = 0; i < 250000 / burst.count + 1; ++i)
+			system.emit(burst, blt::vec2{500, 500});
+		report("particle_system_t::emit (24 particle burst, full 250000 ring)", time_auto_ns([&system, &burst]() {
+			system.emit(burst, blt::vec2{500, 500});
+		}), burst.count);
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <map.h>
+#include <blt/std/utility.h>
+#include <random>
+
+namespace td::bench
+{
+	void run_path()
+	{
+		constexpr blt::size_t segment_count = 256;
+		constexpr blt::size_t point_count = 4096;
+		const auto segments = make_random_path(segment_count, 7);
+		const auto& segment = segments.front();
+
+		std::mt19937 random{7};
+		std::uniform_real_distribution<float> along{0, segment.get_length()};
+		std::uniform_real_distribution<float> world{900, 1100};
+		std::vector<float> distances(point_count);
+		for (auto& distance : distances)
+			distance = along(random);
+		std::vector<blt::vec2> points(point_count);
+
+		blt::gfx::curve2d_t curve{blt::vec2{0, 0}, blt::vec2{50, 100}, blt::vec2{100, 0}};
+		// get_bounding_box() and get_length() are read from values computed here, construction is where their cost lives
+		report("path_segment_t::path_segment_t (bounding box, length, arc table)", time_auto_ns([&]() {
+			const path_segment_t baked{curve};
+			blt::black_box(baked);
+		}), 1);
+
+		report("curve2d_t::get_point", time_auto_ns([&]() {
+			for (blt::size_t i = 0; i < point_count; ++i)
+				points[i] = curve.get_point(distances[i] / segment.get_length());
+			blt::black_box(points.data());
+		}), point_count);
+		report("path_segment_t::get_point", time_auto_ns([&]() {
+			for (blt::size_t i = 0; i < point_count; ++i)
+				points[i] = segment.get_point(distances[i]);
+			blt::black_box(points.data());
+		}), point_count);
+		report("path_segment_t::get_points", time_auto_ns([&]() {
+			segment.get_points(distances.data(), points.data(), point_count);
+			blt::black_box(points.data());
+		}), point_count);
+
+		std::vector<bounding_box_t> boxes;
+		boxes.reserve(segments.size());
+		for (const auto& s : segments)
+			boxes.push_back(s.get_bounding_box());
+		std::vector<blt::vec2> queries(point_count);
+		for (auto& query : queries)
+			query = blt::vec2{world(random), world(random)};
+
+		// the box picked never depends on an earlier result, so the timed loops stay independent tests instead of a dependency chain
+		report("bounding_box_t::contains", time_auto_ns([&]() {
+			blt::size_t hits = 0;
+			for (blt::size_t i = 0; i < point_count; ++i)
+				hits += boxes[i % boxes.size()].contains(queries[i]);
+			blt::black_box(hits);
+		}), point_count);
+		report("bounding_box_t::intersects", time_auto_ns([&]() {
+			blt::size_t hits = 0;
+			for (blt::size_t i = 0; i < boxes.size(); ++i)
+				hits += boxes[i].intersects(boxes[(i + 1) % boxes.size()]);
+			blt::black_box(hits);
+		}), boxes.size());
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <projectiles.h>
+#include <random>
+#include <string>
+
+namespace td::bench
+{
+	void run_projectiles()
+	{
+		constexpr blt::size_t projectile_count = 100000;
+		constexpr float tick = 1.0f / 60.0f;
+
+		for (const blt::size_t enemy_count : {0, 1000, 10000})
+		{
+			enemy_database_t database;
+			map_t map{make_random_path(64, 3), database};
+			const auto total_length = map.get_total_length();
+			for (blt::size_t i = 0; i < enemy_count; ++i)
+				map.spawn(enemy_id_t::TEST, total_length * 0.9f * static_cast<float>(i) / static_cast<float>(enemy_count));
+			map.step(1e-6f);
+
+			// projectiles fly in random directions from points along the path, like towers firing at enemies on it. Every step the pool is
+			// topped back up to the full count, so projectiles removed by hits or expiry are replaced and the live count stays fixed.
+			std::mt19937 random{1337};
+			std::uniform_real_distribution<float> along{0, total_length};
+			std::uniform_real_distribution<float> offset{-100, 100};
+			std::uniform_real_distribution<float> direction{-1, 1};
+			std::vector<projectile_t> sources;
+			for (blt::size_t i = 0; i < projectile_count; ++i)
+			{
+				const auto point = map.get_point(along(random));
+				const blt::vec2 velocity{direction(random) * 400, direction(random) * 400};
+				sources.push_back(projectile_t{blt::vec2{point.x() + offset(random), point.y() + offset(random)}, velocity, 1, 1, 3, 0});
+			}
+			projectile_pool_t pool{projectile_count};
+			std::vector<hit_t> hits;
+			blt::size_t next = 0;
+			const auto refill = [&]() {
+				while (pool.size() < projectile_count)
+				{
+					pool.spawn(sources[next]);
+					next = (next + 1) % sources.size();
+				}
+			};
+			refill();
+			report("projectile_pool_t::step (100000 projectiles, " + std::to_string(enemy_count) + " enemies, 60 Hz, with refill)",
+					time_auto_ns([&]() {
+						hits.clear();
+						pool.step(tick, map, hits);
+						refill();
+					}), projectile_count);
+		}
+	}
+}
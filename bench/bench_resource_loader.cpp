@@ -0,0 +1,96 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <resource_loader.h>
+#include <blt/logging/logging.h>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace td::bench
+{
+	namespace
+	{
+		constexpr blt::size_t TEXTURE_COUNT = 500;
+		constexpr blt::u32 TEXTURE_SIZE = 256;
+
+		// stands in for image decode: every pixel costs a few rounds of integer mixing, roughly what inflating and unfiltering a PNG costs
+		bool decode_synthetic(void*, const std::string& path, image_t& image)
+		{
+			image.width = TEXTURE_SIZE;
+			image.height = TEXTURE_SIZE;
+			image.channels = 4;
+			image.pixels.resize(static_cast<blt::size_t>(TEXTURE_SIZE) * TEXTURE_SIZE * 4);
+			auto state = static_cast<blt::u32>(std::hash<std::string>{}(path)) | 1;
+			for (auto& pixel : image.pixels)
+			{
+				for (int round = 0; round < 2; ++round)
+				{
+					state ^= state << 13;
+					state ^= state >> 17;
+					state ^= state << 5;
+				}
+				pixel = static_cast<blt::u8>(state);
+			}
+			return true;
+		}
+
+		// stands in for the GL upload: one copy of the pixels into driver owned memory
+		void upload_synthetic(void* context, const std::string&, const image_t& image)
+		{
+			auto& staging = *static_cast<std::vector<blt::u8>*>(context);
+			staging.resize(image.pixels.size());
+			std::memcpy(staging.data(), image.pixels.data(), image.pixels.size());
+		}
+
+		void enqueue_synthetic(resource_loader_t& loader, const blt::size_t critical_count)
+		{
+			for (blt::size_t i = 0; i < TEXTURE_COUNT; ++i)
+			{
+				loader.enqueue("synthetic/" + std::to_string(i) + ".png", "texture_" + std::to_string(i),
+								i < critical_count ? resource_priority_t::CRITICAL : resource_priority_t::STREAMED);
+			}
+		}
+	}
+
+	void run_resource_loader()
+	{
+		constexpr blt::size_t critical_count = 16;
+		std::vector<blt::u8> staging;
+		// the decode threads share the cores, with one core the thread counts only measure the loader's overhead
+		if (std::thread::hardware_concurrency() < 2)
+			BLT_WARN("resource_loader_t benchmark on a single core, decode thread counts can't show a speedup");
+
+		// 0 threads is the old behaviour, every image decoded and uploaded one after another on the main thread
+		for (const blt::size_t thread_count : {0, 1, 2, 4, 8})
+		{
+			const auto threads = std::to_string(thread_count) + " decode threads";
+			report("resource_loader_t startup (500 synthetic textures, " + threads + ")", time_ns(3, [&staging, thread_count]() {
+				resource_loader_t loader{decode_synthetic, upload_synthetic, &staging, thread_count};
+				enqueue_synthetic(loader, 0);
+				loader.finish();
+			}), TEXTURE_COUNT);
+			// how long the window waits before the first frame when only a few textures are critical
+			report("resource_loader_t first frame (16 of 500 textures critical, " + threads + ")", time_ns(3, [&staging, thread_count]() {
+				resource_loader_t loader{decode_synthetic, upload_synthetic, &staging, thread_count};
+				enqueue_synthetic(loader, critical_count);
+				loader.finish_critical();
+			}), critical_count);
+		}
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <spatial_grid.h>
+#include <random>
+#include <string>
+
+namespace td::bench
+{
+	void run_spatial_grid()
+	{
+		constexpr blt::size_t query_count = 1000;
+		constexpr float query_radius = 150;
+
+		for (const blt::size_t enemy_count : {1000, 10000, 100000})
+		{
+			std::mt19937 random{1337};
+			std::uniform_real_distribution<float> world{0, 2000};
+			std::vector<blt::vec2> positions;
+			positions.reserve(enemy_count);
+			for (blt::size_t i = 0; i < enemy_count; ++i)
+				positions.emplace_back(world(random), world(random));
+			std::vector<blt::vec2> towers;
+			towers.reserve(query_count);
+			for (blt::size_t i = 0; i < query_count; ++i)
+				towers.emplace_back(world(random), world(random));
+
+			const auto suffix = " (" + std::to_string(enemy_count) + " enemies)";
+			const auto iterations = std::max<blt::size_t>(1, 1000000 / enemy_count);
+
+			spatial_grid_t grid;
+			report("spatial_grid_t::rebuild" + suffix, time_ns(iterations, [&]() {
+				grid.rebuild(positions);
+			}), enemy_count);
+
+			std::vector<blt::u32> found;
+			report("spatial_grid_t::query_radius x1000" + suffix, time_ns(iterations, [&]() {
+				found.clear();
+				for (const auto& tower : towers)
+					grid.query_radius(tower, query_radius, found);
+			}), query_count);
+
+			// what every tower scanning every enemy costs, only run on the smaller sets
+			if (enemy_count > 10000)
+				continue;
+			report("brute force radius x1000" + suffix, time_ns(std::max<blt::size_t>(1, iterations / 10), [&]() {
+				found.clear();
+				for (const auto& tower : towers)
+				{
+					for (blt::size_t i = 0; i < positions.size(); ++i)
+					{
+						const auto d = positions[i] - tower;
+						if (d.x() * d.x() + d.y() * d.y() <= query_radius * query_radius)
+							found.push_back(static_cast<blt::u32>(i));
+					}
+				}
+			}), query_count);
+		}
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <targeting.h>
+#include <blt/std/utility.h>
+#include <random>
+#include <string>
+
+namespace td::bench
+{
+	namespace
+	{
+		template <typename Policy>
+		void report_policy(const std::string& name, const targeting_view_t& view, const std::vector<target_query_t>& queries)
+		{
+			report("find_target<" + name + "> (10000 enemies, 1000 towers)", time_auto_ns([&view, &queries]() {
+				for (const auto& query : queries)
+					blt::black_box(find_target<Policy>(view, query));
+			}), queries.size());
+		}
+	}
+
+	void run_targeting()
+	{
+		constexpr blt::size_t enemy_count = 10000;
+		constexpr blt::size_t tower_count = 1000;
+		constexpr float range = 150;
+
+		enemy_database_t database;
+		map_t map{make_random_path(64, 3), database};
+		const auto total_length = map.get_total_length();
+		for (blt::size_t i = 0; i < enemy_count; ++i)
+			map.spawn(enemy_id_t::TEST, total_length * 0.9f * static_cast<float>(i) / static_cast<float>(enemy_count));
+		// positions and the grid are only filled in by a step
+		map.step(1e-6f);
+
+		// towers stand near the path so most of them have something in range
+		std::mt19937 random{1337};
+		std::uniform_real_distribution<float> along{0, total_length};
+		std::uniform_real_distribution<float> offset{-100, 100};
+		std::vector<blt::vec2> towers;
+		std::vector<blt::u32> coverage_first;
+		std::vector<path_interval_t> coverage;
+		for (blt::size_t i = 0; i < tower_count; ++i)
+		{
+			const auto point = map.get_point(along(random));
+			towers.emplace_back(point.x() + offset(random), point.y() + offset(random));
+			coverage_first.push_back(static_cast<blt::u32>(coverage.size()));
+			find_path_coverage(map, towers.back(), range, coverage);
+		}
+		coverage_first.push_back(static_cast<blt::u32>(coverage.size()));
+		std::vector<target_query_t> queries;
+		for (blt::size_t i = 0; i < tower_count; ++i)
+			queries.push_back(target_query_t{towers[i], range * range, coverage.data() + coverage_first[i], coverage_first[i + 1] - coverage_first[i]});
+
+		// the sorted view is built once per tick and shared by every tower, it is outside the timed loop like it is outside the tower loop
+		const auto view = make_targeting_view(map);
+		report_policy<target_first_t>("first", view, queries);
+		report_policy<target_last_t>("last", view, queries);
+		report_policy<target_strongest_t>("strongest", view, queries);
+		report_policy<target_closest_t>("closest", view, queries);
+
+		// what first targeting costs without the sorted view, every enemy in the radius is visited
+		const auto& grid = map.get_enemy_grid();
+		const auto& distances = map.get_enemies().get_distance_along_path();
+		report("spatial grid first (10000 enemies, 1000 towers)", time_auto_ns([&]() {
+			for (const auto& tower : towers)
+			{
+				auto target = enemy_store_t::INVALID_INDEX;
+				float target_distance = -1;
+				grid.for_each_in_radius(tower, range, [&](const blt::u32 enemy) {
+					if (distances[enemy] > target_distance)
+					{
+						target = enemy;
+						target_distance = distances[enemy];
+					}
+				});
+				blt::black_box(target);
+			}
+		}), tower_count);
+	}
+}
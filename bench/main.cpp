@@ -0,0 +1,130 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <bench.h>
+#include <blt/logging/logging.h>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <random>
+
+namespace td::bench
+{
+	namespace
+	{
+		std::vector<result_t> results;
+
+		void write_json_string(std::ofstream& out, const std::string& str)
+		{
+			out << '"';
+			for (const auto c : str)
+			{
+				if (c == '"' || c == '\\')
+					out << '\\';
+				out << c;
+			}
+			out << '"';
+		}
+
+		// same shape as Google Benchmark's --benchmark_format=json so its compare.py and other tooling can diff two runs
+		bool write_json(const std::string& path)
+		{
+			std::ofstream out{path, std::ios::trunc};
+			out << std::setprecision(17) << "{\n  \"context\": {\"library_build_type\": ";
+#ifdef NDEBUG
+			out << "\"release\"";
+#else
+			out << "\"debug\"";
+#endif
+			out << "},\n  \"benchmarks\": [";
+			for (blt::size_t i = 0; i < results.size(); ++i)
+			{
+				const auto& result = results[i];
+				out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+				write_json_string(out, result.name);
+				out << ", \"run_type\": \"iteration\", \"real_time\": " << result.ns_per_op << ", \"cpu_time\": " << result.ns_per_op
+					<< ", \"time_unit\": \"ns\", \"items\": " << result.items << ", \"items_per_second\": " << result.items_per_second << "}";
+			}
+			out << "\n  ]\n}\n";
+			return static_cast<bool>(out);
+		}
+	}
+
+	void report(const std::string& name, const double ns_per_op, const blt::size_t items)
+	{
+		const auto items_per_second = static_cast<double>(items) * 1e9 / ns_per_op;
+		BLT_INFO("{:<48} {:>14.2f} ns/op {:>16.0f} items/s", name, ns_per_op, items_per_second);
+		results.push_back(result_t{name, ns_per_op, items, items_per_second});
+	}
+
+	const std::vector<result_t>& get_results()
+	{
+		return results;
+	}
+
+	std::vector<path_segment_t> make_random_path(const blt::size_t segment_count, const blt::u32 seed)
+	{
+		std::mt19937 random{seed};
+		std::uniform_real_distribution<float> step{-40, 40};
+		std::vector<path_segment_t> segments;
+		segments.reserve(segment_count);
+		blt::vec2 point{1000, 1000};
+		for (blt::size_t i = 0; i < segment_count; ++i)
+		{
+			const blt::vec2 control{point.x() + step(random), point.y() + step(random)};
+			const blt::vec2 end{control.x() + step(random), control.y() + step(random)};
+			segments.emplace_back(blt::gfx::curve2d_t{point, control, end});
+			point = end;
+		}
+		return segments;
+	}
+}
+
+// usage: tower-defense-bench [--json <path>]
+// with --json every result is also written to path, for tracking regressions between commits
+int main(const int argc, const char** argv)
+{
+	const char* json_path = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			json_path = argv[++i];
+		else
+		{
+			BLT_ERROR("Usage: {} [--json <path>]", argv[0]);
+			return 1;
+		}
+	}
+
+	td::bench::run_enemy_store();
+	td::bench::run_bounding_box();
+	td::bench::run_spatial_grid();
+	td::bench::run_enemy_database();
+	td::bench::run_path();
+	td::bench::run_map();
+	td::bench::run_targeting();
+	td::bench::run_projectiles();
+	td::bench::run_particles();
+	td::bench::run_resource_loader();
+
+	if (json_path && !td::bench::write_json(json_path))
+	{
+		BLT_ERROR("Unable to write '{}'", json_path);
+		return 1;
+	}
+	return 0;
+}
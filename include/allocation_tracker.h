@@ -0,0 +1,58 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <blt/std/types.h>
+
+namespace td::allocation_tracker
+{
+	// only counts when built with TRACK_ALLOCATIONS (TD_TRACK_ALLOCATIONS), otherwise everything reads zero
+	[[nodiscard]] constexpr bool is_enabled()
+	{
+#ifdef TD_TRACK_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// total number of calls to the global operator new / delete since startup, across all threads
+	[[nodiscard]] blt::u64 get_allocations();
+
+	[[nodiscard]] blt::u64 get_deallocations();
+
+	// counts the allocations made between construction and the call to get_allocations()
+	class scope_t
+	{
+	public:
+		scope_t(): m_start{allocation_tracker::get_allocations()}
+		{}
+
+		[[nodiscard]] blt::u64 get_allocations() const
+		{
+			return allocation_tracker::get_allocations() - m_start;
+		}
+
+	private:
+		blt::u64 m_start;
+	};
+}
+
+#endif //ALLOCATION_TRACKER_H
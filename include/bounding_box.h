@@ -42,6 +42,9 @@ namespace td
 
 		[[nodiscard]] bool intersects(const bounding_box_t& other) const;
 
+		// smallest box containing both this box and other
+		[[nodiscard]] bounding_box_t merge(const bounding_box_t& other) const;
+
 		[[nodiscard]] blt::vec2 get_min() const
 		{
 			return m_min;
@@ -56,52 +59,85 @@ namespace td
 		blt::vec2 m_min, m_max;
 	};
 
-	class b_box_node_t
+	// node of the flattened bounding volume hierarchy. The two children of an interior node are always stored next to each other.
+	struct b_box_node_t
+	{
+		bounding_box_t bounds;
+		// interior nodes: index of the left child, the right child is first + 1. leaves: offset into the primitive index list
+		blt::u32 first;
+		// number of primitives in a leaf, zero for interior nodes
+		blt::u32 count;
+
+		[[nodiscard]] bool is_leaf() const
+		{
+			return count != 0;
+		}
+	};
+
+	// static bounding volume hierarchy over a set of boxes, built with binned SAH.
+	// query results are indices into the box list the hierarchy was built from.
+	class b_box_hierarchy_t
 	{
 	public:
-		b_box_node_t(const blt::u8 parentIndex, bounding_box_t* bBox, std::vector<blt::u8> childIndices): parentIndx(parentIndex), bounds(bBox), childIndcs(childIndices)
-		{}
+		b_box_hierarchy_t() = default;
 
-		b_box_node_t(const blt::u8 parentIndex, bounding_box_t* bBox, const blt::u8 depth): parentIndx(parentIndex), bounds(bBox), depth(depth)
-		{}
+		explicit b_box_hierarchy_t(std::vector<bounding_box_t> boxes)
+		{
+			build(std::move(boxes));
+		}
+
+		void build(std::vector<bounding_box_t> boxes);
 
-		void add_child_index(blt::u8 index)
+		[[nodiscard]] blt::size_t size() const
 		{
-			childIndcs.push_back(index);
+			return m_boxes.size();
 		}
 
-		[[nodiscard]] std::vector<blt::u8> get_children() const
+		[[nodiscard]] const std::vector<b_box_node_t>& get_nodes() const
 		{
-			return childIndcs;
+			return m_nodes;
 		}
-		[[nodiscard]] blt::u8 get_depth()
+
+		[[nodiscard]] const bounding_box_t& get_box(const blt::u32 index) const
 		{
-			return depth;
+			return m_boxes[index];
 		}
-		[[nodiscard]] bounding_box_t* get_bounds()
+
+		[[nodiscard]] std::vector<blt::u32> contains(const blt::vec2& point) const
 		{
-			return bounds;
+			std::vector<blt::u32> out;
+			contains(point, out);
+			return out;
 		}
-	private:
-		std::vector<blt::u8> childIndcs;
-		blt::u8 parentIndx;
-		blt::u8 depth;
-		bounding_box_t* bounds;
-	};
 
-	class b_box_hierarchy_t
-	{
-	public:
-		void add_node(bounding_box_t* bBox);
-		blt::u8 size() {
-			return nodeTree.size();
+		[[nodiscard]] std::vector<blt::u32> intersections(const bounding_box_t& other) const
+		{
+			std::vector<blt::u32> out;
+			intersections(other, out);
+			return out;
 		}
-		[[nodiscard]] b_box_node_t container_group(const blt::vec2& point) const;
-		[[nodiscard]] std::vector<bounding_box_t*> contains(const blt::vec2& point) const;
-		[[nodiscard]] std::vector<bounding_box_t*> intersections(const bounding_box_t& other) const;
+
+		// appends the index of every box containing point to out
+		void contains(const blt::vec2& point, std::vector<blt::u32>& out) const;
+
+		// appends the index of every box intersecting other to out
+		void intersections(const bounding_box_t& other, std::vector<blt::u32>& out) const;
+
+		// batched queries. Results are written in CSR form, the matches of query i are results[offsets[i]] to results[offsets[i + 1]]
+		void contains(const blt::vec2* points, blt::size_t count, std::vector<blt::u32>& offsets, std::vector<blt::u32>& results) const;
+
+		void intersections(const bounding_box_t* boxes, blt::size_t count, std::vector<blt::u32>& offsets, std::vector<blt::u32>& results) const;
+
 	private:
-		std::vector<b_box_node_t> nodeTree;
-		blt::u8 search_children(bounding_box_t& other, blt::u8 startIndx);
+		template <typename Overlaps>
+		void query(const Overlaps& overlaps, std::vector<blt::u32>& out) const;
+
+		void subdivide(blt::u32 node_index, const std::vector<blt::vec2>& centers, blt::u32 depth);
+
+		std::vector<bounding_box_t> m_boxes;
+		std::vector<b_box_node_t> m_nodes;
+		// primitive indices, reordered during the build so every leaf references a contiguous range
+		std::vector<blt::u32> m_indices;
 	};
 }
 
@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include <enemy_store.h>
+#include <fwddecl.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// a single hit produced during a tick, resolved in bulk by damage_resolver_t
+	struct hit_t
+	{
+		enemy_handle_t enemy;
+		float amount;
+		// damage_type_t flags carried by the hit
+		blt::u8 damage_mask;
+	};
+
+	// 1 if a hit carrying hit_mask hurts an enemy resisting resist_mask, 0 otherwise. Written without branches so it can sit in the hit loop:
+	// untyped (BASE) damage is never resisted, typed damage lands if any of its types isn't resisted,
+	// LOVE damage always lands and an enemy with LOVE resistance can only be hurt by LOVE.
+	inline blt::u32 damage_applies(const blt::u8 hit_mask, const blt::u8 resist_mask)
+	{
+		constexpr auto love = static_cast<blt::u32>(damage_type_t::LOVE);
+		constexpr auto typed_bits = love - 1;
+		const blt::u32 love_hit = (hit_mask & love) != 0;
+		const blt::u32 love_only = (resist_mask & love) != 0;
+		const blt::u32 typed = hit_mask & typed_bits;
+		const blt::u32 typed_lands = (typed == 0) | ((typed & ~static_cast<blt::u32>(resist_mask)) != 0);
+		return love_hit | (typed_lands & (love_only ^ 1u));
+	}
+
+	class damage_resolver_t
+	{
+	public:
+		// applies every hit to the store's health_left. Hits on enemies that no longer exist are dropped.
+		// the dense index of every enemy brought to zero health or below is appended to kills, in increasing order.
+		// killed enemies are not removed, that is left to the caller.
+		void resolve(enemy_store_t& enemies, const std::vector<hit_t>& hits, std::vector<blt::u32>& kills);
+
+	private:
+		// damage accumulated per dense enemy index this resolve
+		std::vector<float> m_pending;
+	};
+}
+
+#endif //DAMAGE_H
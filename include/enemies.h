@@ -24,16 +24,27 @@
 #include <vector>
 #include <blt/std/types.h>
 #include <bounding_box.h>
+#include <mapped_file.h>
+#include <string_view>
 
 namespace td
 {
 	// define enemies here
 	// if you add more you must register them.
-	enum class enemy_id_t
+	enum class enemy_id_t : blt::u32
 	{
-		TEST
+		TEST,
+		TEST_SPLITTER
 	};
 
+	// number of enemy_id_t values, every database must define at least this many enemies
+	constexpr blt::u32 ENEMY_ID_COUNT = 2;
+
+	// the names enemies go by in text sources
+	bool parse_enemy_id(std::string_view name, enemy_id_t& id);
+
+	std::string_view get_enemy_name(enemy_id_t id);
+
 	struct enemy_instance_t
 	{
 		enemy_instance_t(const enemy_id_t id, const float health_left) : id{id}, health_left{health_left}
@@ -41,8 +52,7 @@ namespace td
 
 		enemy_id_t id;
 		float health_left;
-		float percent_along_path = 0;
-		bool is_alive = true;
+		float distance_along_path = 0;
 	};
 
 	class enemy_t
@@ -128,6 +138,60 @@ namespace td
 		float m_speed = 1.0f;
 	};
 
+	// the per type values read every tick, copied out of enemy_t so hot loops don't pull strings and vectors into cache.
+	// this is also the on disk record of the binary database, so it has to stay fixed size and free of pointers.
+	struct enemy_stats_t
+	{
+		float health = 1;
+		float damage = 1;
+		float speed = 1;
+		// interned texture index, see enemy_database_t::get_texture_name
+		blt::u32 texture = 0;
+		// children are stored in a side table, [first_child, first_child + child_count)
+		blt::u32 first_child = 0;
+		blt::u32 child_count = 0;
+		// damage_type_t mask
+		blt::u8 resistance = 0;
+		blt::u8 padding[3]{};
+	};
+
+	static_assert(sizeof(enemy_stats_t) == 28, "enemy_stats_t is part of the binary database format");
+
+	// contiguous run of child ids inside the database's flattened children table
+	struct enemy_children_t
+	{
+		const enemy_id_t* first;
+		blt::u32 count;
+
+		[[nodiscard]] const enemy_id_t* begin() const
+		{
+			return first;
+		}
+
+		[[nodiscard]] const enemy_id_t* end() const
+		{
+			return first + count;
+		}
+	};
+
+	// binary database layout, all in host byte order, every section 4 byte aligned:
+	// header, enemy_stats_t[enemy_count], enemy_id_t[child_count], u32 texture_offsets[texture_count + 1], char texture_names[]
+	struct enemy_database_header_t
+	{
+		static constexpr blt::u32 MAGIC = 0x42444554; // "TEDB"
+		static constexpr blt::u32 VERSION = 1;
+
+		blt::u32 magic = MAGIC;
+		blt::u32 version = VERSION;
+		blt::u32 enemy_count = 0;
+		blt::u32 child_count = 0;
+		blt::u32 texture_count = 0;
+		blt::u32 texture_bytes = 0;
+	};
+
+	// enemy definitions can come from three places: register_entities() (the built in defaults), a text source (load_text) or
+	// a binary database compiled from the text source (load_binary). Whichever is used, the lookups below read the same packed tables,
+	// the binary database is simply mapped and used in place.
 	class enemy_database_t
 	{
 	public:
@@ -136,23 +200,80 @@ namespace td
 			register_entities();
 		}
 
-		void add_enemy(enemy_id_t enemy_id, const enemy_t& enemy)
+		// adds or replaces a definition and repacks the tables. Replaces anything loaded from a binary database.
+		void add_enemy(enemy_id_t enemy_id, const enemy_t& enemy);
+
+		// overrides the health, damage, speed and resistance of an existing enemy, used when tuning. Texture and children are kept.
+		void set_stats(enemy_id_t id, const enemy_stats_t& stats);
+
+		// loads definitions from the text source format, see res/enemies.txt. Returns false and keeps the current definitions
+		// if the file can't be read or has an error.
+		bool load_text(const std::string& path);
+
+		// maps a database written by write_binary(). Nothing is parsed, the header is checked and the tables are used from the mapping.
+		// returns false and keeps the current definitions if the file is missing or doesn't look like a database.
+		bool load_binary(const std::string& path);
+
+		bool write_binary(const std::string& path) const;
+
+		// hash of the packed tables, two databases with the same definitions hash the same
+		[[nodiscard]] blt::u64 compute_hash() const;
+
+		[[nodiscard]] const enemy_stats_t& get_stats(enemy_id_t id) const
+		{
+			return m_stats[static_cast<blt::u32>(id)];
+		}
+
+		// texture names are interned so per enemy data can carry a small index instead of a string
+		[[nodiscard]] blt::u32 get_texture_index(enemy_id_t id) const
+		{
+			return get_stats(id).texture;
+		}
+
+		[[nodiscard]] std::string_view get_texture_name(const blt::u32 texture) const
+		{
+			return std::string_view{m_texture_names + m_texture_offsets[texture], m_texture_offsets[texture + 1] - m_texture_offsets[texture]};
+		}
+
+		[[nodiscard]] blt::u32 get_texture_count() const
+		{
+			return m_header->texture_count;
+		}
+
+		[[nodiscard]] blt::u32 get_enemy_count() const
 		{
-			const auto index = static_cast<blt::i32>(enemy_id);
-			if (static_cast<blt::i32>(enemies_registry.size()) <= index)
-				enemies_registry.resize(index + 1, enemy_t{"no_enemy_texture", {}});
-			enemies_registry[index] = enemy;
+			return m_header->enemy_count;
 		}
 
-		[[nodiscard]] const enemy_t& get(enemy_id_t id) const
+		// children spawned when an enemy of this type dies, served from the flattened table
+		[[nodiscard]] enemy_children_t get_children(enemy_id_t id) const
 		{
-			return enemies_registry[static_cast<blt::i32>(id)];
+			const auto& stats = get_stats(id);
+			return enemy_children_t{m_children + stats.first_child, stats.child_count};
 		}
 
 	private:
 		void register_entities();
 
+		// packs enemies_registry into m_packed and points the tables at it
+		void rebuild_tables();
+
+		// checks the blob looks like a complete database, then points the tables into it
+		bool attach(const void* data, blt::size_t size);
+
+		// the definitions as written in code or text, only used to build the packed tables
 		std::vector<enemy_t> enemies_registry;
+		// packed tables built from enemies_registry, in the binary database layout
+		std::vector<blt::u32> m_packed;
+		// binary database the tables point into, when loaded with load_binary()
+		mapped_file_t m_file;
+
+		const enemy_database_header_t* m_header = nullptr;
+		blt::size_t m_size = 0;
+		const enemy_stats_t* m_stats = nullptr;
+		const enemy_id_t* m_children = nullptr;
+		const blt::u32* m_texture_offsets = nullptr;
+		const char* m_texture_names = nullptr;
 	};
 }
 
@@ -0,0 +1,217 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENEMY_STORE_H
+#define ENEMY_STORE_H
+
+#include <enemies.h>
+#include <snapshot.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// stable reference to an enemy inside an enemy_store_t. Dense indices change whenever an enemy is removed,
+	// handles stay valid until the enemy they point to is removed, after which the generation no longer matches.
+	struct enemy_handle_t
+	{
+		blt::u32 index = 0;
+		blt::u32 generation = 0;
+
+		friend bool operator==(const enemy_handle_t& a, const enemy_handle_t& b)
+		{
+			return a.index == b.index && a.generation == b.generation;
+		}
+
+		friend bool operator!=(const enemy_handle_t& a, const enemy_handle_t& b)
+		{
+			return !(a == b);
+		}
+	};
+
+	// enemies waiting to be inserted with enemy_store_t::add_batch, laid out like the store itself
+	struct enemy_batch_t
+	{
+		std::vector<enemy_id_t> ids;
+		std::vector<float> health_left;
+		std::vector<float> distance_along_path;
+		std::vector<float> speed;
+		std::vector<blt::u8> resistances;
+
+		void push(const enemy_instance_t& enemy, const float enemy_speed, const blt::u8 resistance)
+		{
+			ids.push_back(enemy.id);
+			health_left.push_back(enemy.health_left);
+			distance_along_path.push_back(enemy.distance_along_path);
+			speed.push_back(enemy_speed);
+			resistances.push_back(resistance);
+		}
+
+		void clear()
+		{
+			ids.clear();
+			health_left.clear();
+			distance_along_path.clear();
+			speed.clear();
+			resistances.clear();
+		}
+
+		[[nodiscard]] bool empty() const
+		{
+			return ids.empty();
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return ids.size();
+		}
+	};
+
+	// structure of arrays storage for the enemies living on a path segment.
+	// the arrays are kept dense, removing an enemy moves the last enemy into its slot (swap and pop), so iteration only ever
+	// touches live enemies. A generation indexed sparse table maps handles to their current dense index.
+	class enemy_store_t
+	{
+	public:
+		static constexpr blt::u32 INVALID_INDEX = ~0u;
+
+		// speed is the distance along the path this enemy moves per second, resistance is a damage_type_t mask
+		enemy_handle_t add(const enemy_instance_t& enemy, float speed, blt::u8 resistance = 0);
+
+		// appends every enemy in the batch, growing each array once. The new enemies take the dense indices [size(), size() + batch.size())
+		// in batch order, their handles can be fetched with get_handle().
+		void add_batch(const enemy_batch_t& batch);
+
+		// removes the enemy at the dense index. The last enemy is moved into its place.
+		void remove(blt::size_t index);
+
+		void remove(const enemy_handle_t handle)
+		{
+			const auto index = get_index(handle);
+			if (index != INVALID_INDEX)
+				remove(index);
+		}
+
+		// removes every dense index in the list, which must be sorted in increasing order (like the output of advance).
+		// removal happens back to front so swapped in enemies never land on an index which is still pending removal.
+		void remove_sorted(const std::vector<blt::u32>& indices)
+		{
+			for (auto it = indices.rbegin(); it != indices.rend(); ++it)
+				remove(*it);
+		}
+
+		// returns the current dense index of the enemy or INVALID_INDEX if the handle is stale
+		[[nodiscard]] blt::u32 get_index(const enemy_handle_t handle) const
+		{
+			if (handle.index >= m_sparse.size() || m_sparse[handle.index].generation != handle.generation)
+				return INVALID_INDEX;
+			return m_sparse[handle.index].dense_index;
+		}
+
+		[[nodiscard]] bool is_valid(const enemy_handle_t handle) const
+		{
+			return get_index(handle) != INVALID_INDEX;
+		}
+
+		[[nodiscard]] enemy_handle_t get_handle(const blt::size_t index) const
+		{
+			const auto sparse_index = m_handles[index];
+			return enemy_handle_t{sparse_index, m_sparse[sparse_index].generation};
+		}
+
+		void reserve(blt::size_t count);
+
+		void clear();
+
+		// every array, handle table included, so handles taken before a snapshot stay valid after restoring it
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		// moves every enemy forward by speed * delta. The index of every enemy whose distance reached limit
+		// is appended to crossed, in increasing order. Crossed enemies are not removed, that is left to the caller.
+		void advance(float delta, float limit, std::vector<blt::u32>& crossed)
+		{
+			advance(delta, limit, 0, size(), crossed);
+		}
+
+		// advances only the enemies in [begin, end). Disjoint ranges can be advanced from different threads at the same time.
+		void advance(float delta, float limit, blt::size_t begin, blt::size_t end, std::vector<blt::u32>& crossed);
+
+		[[nodiscard]] bool empty() const
+		{
+			return m_ids.empty();
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_ids.size();
+		}
+
+		[[nodiscard]] const std::vector<enemy_id_t>& get_ids() const
+		{
+			return m_ids;
+		}
+
+		[[nodiscard]] std::vector<float>& get_health_left()
+		{
+			return m_health_left;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_health_left() const
+		{
+			return m_health_left;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_distance_along_path() const
+		{
+			return m_distance_along_path;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_speed() const
+		{
+			return m_speed;
+		}
+
+		[[nodiscard]] const std::vector<blt::u8>& get_resistances() const
+		{
+			return m_resistances;
+		}
+
+	private:
+		struct sparse_entry_t
+		{
+			blt::u32 dense_index;
+			blt::u32 generation;
+		};
+
+		// dense arrays, all the same length
+		std::vector<enemy_id_t> m_ids;
+		std::vector<float> m_health_left;
+		std::vector<float> m_distance_along_path;
+		std::vector<float> m_speed;
+		std::vector<blt::u8> m_resistances;
+		// sparse slot owning each dense element, used to patch the sparse table on swap and pop
+		std::vector<blt::u32> m_handles;
+
+		std::vector<sparse_entry_t> m_sparse;
+		std::vector<blt::u32> m_free_handles;
+	};
+}
+
+#endif //ENEMY_STORE_H
@@ -0,0 +1,221 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <enemies.h>
+#include <enemy_store.h>
+#include <blt/std/types.h>
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace td
+{
+	// every event type, the order here is the order in which event_bus_t dispatches them
+	enum class event_id_t : blt::u8
+	{
+		ENEMY_DIED,
+		ENEMY_LEAKED,
+		TOWER_FIRED,
+		PROJECTILE_HIT
+	};
+
+	struct enemy_died_event_t
+	{
+		static constexpr event_id_t ID = event_id_t::ENEMY_DIED;
+
+		enemy_id_t enemy;
+		float x, y;
+		float distance_along_path;
+	};
+
+	struct enemy_leaked_event_t
+	{
+		static constexpr event_id_t ID = event_id_t::ENEMY_LEAKED;
+
+		enemy_id_t enemy;
+		float damage;
+	};
+
+	struct tower_fired_event_t
+	{
+		static constexpr event_id_t ID = event_id_t::TOWER_FIRED;
+
+		blt::u32 tower;
+		// position of the tower
+		float x, y;
+		enemy_handle_t target;
+	};
+
+	struct projectile_hit_event_t
+	{
+		static constexpr event_id_t ID = event_id_t::PROJECTILE_HIT;
+
+		// position of the projectile when it hit
+		float x, y;
+		enemy_handle_t enemy;
+	};
+
+	// growable power of two ring buffer of plain data events
+	template <typename T>
+	class event_ring_t
+	{
+	public:
+		explicit event_ring_t(const blt::size_t capacity = 1024)
+		{
+			blt::size_t size = 1;
+			while (size < capacity)
+				size <<= 1;
+			m_data.resize(size);
+		}
+
+		void push(const T& value)
+		{
+			if (size() == m_data.size())
+				grow();
+			m_data[m_tail & (m_data.size() - 1)] = value;
+			++m_tail;
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_tail - m_head;
+		}
+
+		// pops the oldest count events into out, replacing its contents. The ring is free to grow again as soon as this returns,
+		// so whatever reads the events can safely push more.
+		void consume(const blt::size_t count, std::vector<T>& out)
+		{
+			const auto mask = m_data.size() - 1;
+			const auto begin = m_head & mask;
+			const auto first = std::min(count, m_data.size() - begin);
+			out.clear();
+			out.insert(out.end(), m_data.begin() + static_cast<std::ptrdiff_t>(begin), m_data.begin() + static_cast<std::ptrdiff_t>(begin + first));
+			out.insert(out.end(), m_data.begin(), m_data.begin() + static_cast<std::ptrdiff_t>(count - first));
+			m_head += count;
+		}
+
+	private:
+		void grow()
+		{
+			std::vector<T> data(m_data.size() * 2);
+			const auto count = size();
+			for (blt::size_t i = 0; i < count; ++i)
+				data[i] = m_data[(m_head + i) & (m_data.size() - 1)];
+			m_data = std::move(data);
+			m_head = 0;
+			m_tail = count;
+		}
+
+		std::vector<T> m_data;
+		blt::size_t m_head = 0;
+		blt::size_t m_tail = 0;
+	};
+
+	// typed event bus. Every event type has its own ring buffer and its own flat array of handlers. Events are queued during the tick
+	// and dispatch() hands each handler whole arrays of events, so ten thousand deaths are a handful of calls rather than ten thousand.
+	// events pushed while dispatching are kept for the next dispatch.
+	class event_bus_t
+	{
+	public:
+		template <typename Event>
+		using handler_func_t = void(*)(void* context, const Event* events, blt::size_t count);
+
+		template <typename Event>
+		void subscribe(const handler_func_t<Event> func, void* context = nullptr)
+		{
+			channel<Event>().handlers.push_back(handler_t<Event>{func, context});
+		}
+
+		// subscribes a member function, resolved at compile time so dispatch is a plain function pointer call
+		template <typename Event, typename T, void (T::*Method)(const Event*, blt::size_t)>
+		void subscribe(T& object)
+		{
+			subscribe<Event>([](void* context, const Event* events, const blt::size_t count) {
+				(static_cast<T*>(context)->*Method)(events, count);
+			}, &object);
+		}
+
+		template <typename Event>
+		void push(const Event& event)
+		{
+			channel<Event>().queue.push(event);
+		}
+
+		template <typename Event>
+		[[nodiscard]] blt::size_t pending() const
+		{
+			return std::get<static_cast<blt::size_t>(Event::ID)>(m_channels).queue.size();
+		}
+
+		// delivers every queued event, one event type at a time in event_id_t order
+		void dispatch()
+		{
+			std::apply([](auto&... channels) {
+				(channels.dispatch(), ...);
+			}, m_channels);
+		}
+
+	private:
+		template <typename Event>
+		struct handler_t
+		{
+			handler_func_t<Event> func;
+			void* context;
+		};
+
+		template <typename Event>
+		struct channel_t
+		{
+			event_ring_t<Event> queue;
+			std::vector<handler_t<Event>> handlers;
+			// the events being dispatched. Handlers pushing the same event type may grow the queue, so they never see the queue itself.
+			// reused between dispatches, it only allocates while it grows.
+			std::vector<Event> dispatching;
+
+			void dispatch()
+			{
+				if (queue.size() == 0)
+					return;
+				queue.consume(queue.size(), dispatching);
+				for (const auto& handler : handlers)
+					handler.func(handler.context, dispatching.data(), dispatching.size());
+			}
+		};
+
+		template <typename Event>
+		channel_t<Event>& channel()
+		{
+			constexpr auto index = static_cast<blt::size_t>(Event::ID);
+			static_assert(std::is_same_v<std::tuple_element_t<index, channels_t>, channel_t<Event>>,
+						"event type is not registered in event_bus_t, or its ID doesn't match its position");
+			return std::get<index>(m_channels);
+		}
+
+		// registered event types, ordered to match event_id_t
+		using channels_t = std::tuple<channel_t<enemy_died_event_t>, channel_t<enemy_leaked_event_t>, channel_t<tower_fired_event_t>,
+									channel_t<projectile_hit_event_t>>;
+
+		channels_t m_channels;
+	};
+}
+
+#endif //EVENTS_H
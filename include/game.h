@@ -19,63 +19,180 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <damage.h>
 #include <enemies.h>
+#include <events.h>
+#include <map.h>
+#include <random.h>
+#include <replay.h>
+#include <towers.h>
+#include <projectiles.h>
+#include <waves.h>
 #include <vector>
-#include <functional>
-#include <string>
 
 namespace td
 {
+	// owns the simulation state. Nothing in here reads the window clock, time only moves through step() and update()
+	// so the same code drives the windowed game and the headless runner.
+	// the simulation is deterministic: the same seed, tick length and inputs give bit identical state on every run, serial or parallel.
+	// player actions go through queue_input() so they land on a tick boundary and can be recorded into a replay.
 	class game_t
 	{
 	public:
+		static constexpr float DEFAULT_TICK_LENGTH = 1.0f / 60.0f;
 
-		void render();
+		explicit game_t(const std::vector<path_segment_t>& path_segments, float tick_length = DEFAULT_TICK_LENGTH, blt::u64 seed = 0);
 
-		void update();
+		// map_t keeps pointers to our database and event bus
+		game_t(const game_t&) = delete;
+		game_t& operator=(const game_t&) = delete;
 
-	private:
-	};
+		// advances the simulation by exactly one tick of length dt
+		void step(float dt);
 
-	class event_handler_t
-	{
-		// I don't want to keep the parameter as a void pointer, maybe it would be nice to have a gameObject class or sumthing,
-		// or diverge into unique event_handlers types, idk
-		std::function<void(void*)> callback;
+		// applies the input at the start of the next tick. The input's tick is filled in here.
+		void queue_input(const input_t& input)
+		{
+			m_inputs.push_back(input);
+			m_inputs.back().tick = m_tick;
+		}
 
-		// I'm preparing for when a handler would contain more than just a regular std::function, so this class would contain that stuff
-	public:
-		explicit event_handler_t(std::function<void(void*)> handler) : callback(std::move(handler))
-		{};
+		// records every input from now on, with a state hash every hash_interval ticks. Must be called before the first step
+		// for the replay to be playable.
+		void start_recording(blt::u32 hash_interval);
 
-		void call(void* target) const
+		[[nodiscard]] const replay_t& get_replay() const
 		{
-			return callback(target);
+			return m_replay;
 		}
 
-	private:
-	};
+		// writes everything needed to continue the simulation from the current tick into buffer, replacing its contents.
+		// take snapshots between ticks, restoring one into another game forks the simulation.
+		void save_snapshot(std::vector<blt::u8>& buffer) const;
 
-	class event_t
-	{
-	public:
-		void callHandler(void* target)
+		// restores a snapshot saved by a game with the same path, tick length and enemy definitions. Returns false without touching
+		// the game if the header doesn't match, a snapshot damaged past its header leaves the game in an unspecified state.
+		// restoring stops any replay recording, the replay would no longer describe this game.
+		bool restore_snapshot(const std::vector<blt::u8>& buffer);
+
+		// hash over everything which affects future ticks: enemies, towers, game time, damage taken and the rng
+		[[nodiscard]] blt::u64 compute_state_hash() const;
+
+		// queues a hit to be resolved with every other hit at the end of the current tick, after enemies have moved
+		void queue_hit(const hit_t& hit)
 		{
-			handler.call(target);
+			m_hits.push_back(hit);
 		}
 
-	private:
-		event_handler_t handler;
-		std::string signature;
-	};
+		// feeds frame_delta seconds into a fixed timestep accumulator, running as many whole ticks as fit. returns the number of ticks run
+		blt::u32 update(float frame_delta);
 
-	class event_scheduler_t
-	{
-	public:
-		void add_event_listener(event_t ev, event_handler_t handler);
+		void render(blt::gfx::batch_renderer_2d& renderer);
+
+		// writes the current enemy sprites into the back instance buffer and publishes it. update() does this once per frame.
+		void publish_instances();
+
+		[[nodiscard]] const sprite_instance_buffer_t& get_enemy_instances() const
+		{
+			return m_enemy_instances;
+		}
+
+		[[nodiscard]] map_t& get_map()
+		{
+			return m_map;
+		}
+
+		[[nodiscard]] const map_t& get_map() const
+		{
+			return m_map;
+		}
+
+		// towers fire after enemies have moved, their hits are resolved in the same tick. Place towers with a PLACE_TOWER input.
+		[[nodiscard]] tower_system_t& get_towers()
+		{
+			return m_towers;
+		}
+
+		[[nodiscard]] const tower_system_t& get_towers() const
+		{
+			return m_towers;
+		}
+
+		// projectiles fired by towers. They move and collide after the enemies, their hits are resolved with the towers' in the same tick.
+		[[nodiscard]] const projectile_pool_t& get_projectiles() const
+		{
+			return m_projectiles;
+		}
+
+		// waves are spawned at the start of every tick, before enemies move. Waves added here directly aren't recorded,
+		// use a START_WAVE input for that.
+		[[nodiscard]] wave_scheduler_t& get_waves()
+		{
+			return m_waves;
+		}
+
+		// events queued during a step are dispatched at the end of that step
+		[[nodiscard]] event_bus_t& get_events()
+		{
+			return m_events;
+		}
+
+		[[nodiscard]] enemy_database_t& get_database()
+		{
+			return m_database;
+		}
+
+		// the only source of randomness the simulation may use
+		[[nodiscard]] rng_t& get_rng()
+		{
+			return m_rng;
+		}
+
+		[[nodiscard]] blt::u64 get_tick() const
+		{
+			return m_tick;
+		}
+
+		// seconds of game time simulated so far
+		[[nodiscard]] double get_time() const
+		{
+			return m_time;
+		}
+
+		[[nodiscard]] float get_tick_length() const
+		{
+			return m_tick_length;
+		}
+
+		// total damage dealt by enemies which reached the end of the path
+		[[nodiscard]] float get_damage_taken() const
+		{
+			return m_damage_taken;
+		}
 
 	private:
-		void* target = nullptr;
+		enemy_database_t m_database;
+		event_bus_t m_events;
+		map_t m_map;
+		sprite_instance_buffer_t m_enemy_instances;
+		float m_tick_length;
+		float m_accumulator = 0;
+		blt::u64 m_tick = 0;
+		// kept in double so it doesn't drift over long sessions of small steps
+		double m_time = 0;
+		float m_damage_taken = 0;
+		// hits queued this tick, cleared once resolved
+		std::vector<hit_t> m_hits;
+		wave_scheduler_t m_waves;
+		std::vector<wave_spawn_t> m_wave_spawns;
+		tower_system_t m_towers;
+		projectile_pool_t m_projectiles;
+		rng_t m_rng;
+		blt::u64 m_seed;
+		// inputs waiting for the start of the next tick
+		std::vector<input_t> m_inputs;
+		replay_t m_replay;
+		bool m_recording = false;
 	};
 }
 
@@ -0,0 +1,59 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <blt/std/types.h>
+#include <type_traits>
+#include <vector>
+
+namespace td
+{
+	// 64 bit FNV-1a over raw bytes, floats included, so any bit of divergence changes the hash
+	struct fnv1a_t
+	{
+		blt::u64 value = 14695981039346656037ull;
+
+		void add_bytes(const void* data, const blt::size_t size)
+		{
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (blt::size_t i = 0; i < size; ++i)
+			{
+				value ^= bytes[i];
+				value *= 1099511628211ull;
+			}
+		}
+
+		template <typename T>
+		void add(const T& data)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			add_bytes(&data, sizeof(T));
+		}
+
+		template <typename T>
+		void add(const std::vector<T>& data)
+		{
+			add(data.size());
+			add_bytes(data.data(), data.size() * sizeof(T));
+		}
+	};
+}
+
+#endif //HASH_H
@@ -0,0 +1,37 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// decoded pixels, rows top to bottom
+	struct image_t
+	{
+		blt::u32 width = 0;
+		blt::u32 height = 0;
+		blt::u32 channels = 0;
+		std::vector<blt::u8> pixels;
+	};
+}
+
+#endif //IMAGE_H
@@ -0,0 +1,114 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <blt/std/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace td
+{
+	// fixed pool of worker threads, each with its own job deque. Workers pop from the back of their own deque and steal from the
+	// front of the others when they run dry. Jobs are a function pointer and a context pointer, submitting work never allocates
+	// beyond the deque nodes.
+	class job_system_t
+	{
+	public:
+		// the thread calling parallel_for helps run jobs, so by default one less worker than there are hardware threads is created
+		explicit job_system_t(blt::size_t worker_count = default_worker_count());
+
+		~job_system_t();
+
+		job_system_t(const job_system_t&) = delete;
+		job_system_t& operator=(const job_system_t&) = delete;
+
+		// calls func(begin, end) over [0, count) split into ranges of at most grain elements, returning once every range is done.
+		// the ranges are fixed by count and grain alone, so anything written per range is the same no matter which thread ran it.
+		template <typename Func>
+		void parallel_for(const blt::size_t count, const blt::size_t grain, Func&& func)
+		{
+			if (count == 0)
+				return;
+			if (m_workers.empty() || count <= grain)
+			{
+				func(static_cast<blt::size_t>(0), count);
+				return;
+			}
+			using func_t = std::remove_reference_t<Func>;
+			const auto trampoline = [](void* context, const blt::size_t begin, const blt::size_t end) {
+				(*static_cast<func_t*>(context))(begin, end);
+			};
+			run_jobs(trampoline, const_cast<void*>(static_cast<const void*>(&func)), count, grain);
+		}
+
+		[[nodiscard]] blt::size_t get_worker_count() const
+		{
+			return m_workers.size();
+		}
+
+		static blt::size_t default_worker_count()
+		{
+			const auto hardware = std::thread::hardware_concurrency();
+			return hardware > 1 ? hardware - 1 : 0;
+		}
+
+	private:
+		using job_func_t = void(*)(void*, blt::size_t, blt::size_t);
+
+		struct job_t
+		{
+			job_func_t func;
+			void* context;
+			blt::size_t begin;
+			blt::size_t end;
+			std::atomic<blt::size_t>* remaining;
+		};
+
+		struct job_queue_t
+		{
+			std::mutex mutex;
+			std::deque<job_t> jobs;
+		};
+
+		void run_jobs(job_func_t func, void* context, blt::size_t count, blt::size_t grain);
+
+		void worker_main(blt::size_t index);
+
+		bool pop(blt::size_t queue, job_t& job);
+
+		bool steal(blt::size_t thief, job_t& job);
+
+		static void run(const job_t& job);
+
+		std::vector<std::unique_ptr<job_queue_t>> m_queues;
+		std::vector<std::thread> m_workers;
+		std::atomic<blt::size_t> m_queued{0};
+		std::atomic<bool> m_running{true};
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_wake;
+	};
+}
+
+#endif //JOB_SYSTEM_H
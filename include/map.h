@@ -20,8 +20,16 @@
 #define MAP_H
 
 #include <enemies.h>
+#include <enemy_store.h>
+#include <events.h>
+#include <damage.h>
+#include <waves.h>
+#include <spatial_grid.h>
+#include <job_system.h>
+#include <sprite_instances.h>
 #include <fwddecl.h>
 #include <bounding_box.h>
+#include <config.h>
 #include <blt/gfx/renderer/batch_2d_renderer.h>
 #include <blt/math/vectors.h>
 
@@ -39,55 +47,184 @@ namespace td
 			return m_bounding_box;
 		}
 
-		void remove_enemy(const blt::size_t index)
+		[[nodiscard]] float get_length() const
 		{
-			m_enemies[index].is_alive = false;
-			m_empty_indices.emplace_back(index);
+			return m_curve_length;
 		}
 
-		void add_enemy(const enemy_instance_t& enemy)
-		{
-			if (!m_empty_indices.empty())
-			{
-				m_enemies[m_empty_indices.back()] = enemy;
-				m_empty_indices.pop_back();
-			} else
-			{
-				m_enemies.push_back(enemy);
-			}
-		}
+		// position of the point distance units along the segment, using the baked arc length table
+		[[nodiscard]] blt::vec2 get_point(float distance) const;
+
+		// converts count distances into positions in a single pass over the table
+		void get_points(const float* distances, blt::vec2* points, blt::size_t count) const;
 
 	private:
 		static bounding_box_t get_bounding_box(const blt::gfx::curve2d_t& curve, blt::i32 segments);
 
+		void bake_arc_length_table(blt::i32 segments);
+
 		bounding_box_t m_bounding_box;
 		blt::gfx::curve2d_t m_curve;
-		float m_curve_length;
-		std::vector<enemy_instance_t> m_enemies;
-		std::vector<blt::size_t> m_empty_indices;
+		float m_curve_length = 0;
+		// points spaced m_arc_step apart along the curve, so a distance maps directly to an index
+		std::vector<blt::vec2> m_arc_points;
+		float m_arc_step = 0;
+		float m_inv_arc_step = 0;
 	};
 
+	// the path used by the debug build and the headless runner
+	std::vector<path_segment_t> make_default_path();
+
 	class map_t
 	{
 	public:
-		explicit map_t(const std::vector<path_segment_t>& path_segments, enemy_database_t& database): m_path_segments{path_segments},
-																									m_database{&database}
-		{}
+		// entry of the sorted view, enemies ordered by their distance along the whole path
+		struct sorted_enemy_t
+		{
+			float distance;
+			blt::u32 index;
+		};
+
+		// path_segments must hold at least one segment
+		explicit map_t(const std::vector<path_segment_t>& path_segments, enemy_database_t& database);
+
+		enemy_handle_t spawn(enemy_id_t id, float distance = 0);
+
+		// inserts every spawn in one batch. Each enemy starts as far along the path as it would have travelled in its age,
+		// so enemies of a wave stay staggered even when many are due in the same tick.
+		void spawn_batch(const std::vector<wave_spawn_t>& spawns);
+
+		// draws the path. Enemies are drawn by the instanced sprite renderer from write_instances()
+		void draw(blt::gfx::batch_renderer_2d& renderer);
+
+		// appends a sprite for every enemy, in dense order, using the positions from the last step
+		void write_instances(std::vector<sprite_instance_t>& instances) const;
+
+		// advances every enemy by dt seconds, returns the damage dealt by enemies which reached the end of the path
+		float step(float dt);
 
-		void spawn(const enemy_id_t id)
+		// resolves a tick's worth of hits in one batch. Killed enemies are removed and, when an event bus is set, an enemy_died_event_t is
+		// queued for each. The children of every killed enemy are spawned where their parent died. Positions and the enemy grid stay in sync with the store,
+		// enemies added by spawn() since the last step get their positions here.
+		void apply_damage(const std::vector<hit_t>& hits);
+
+		// enemies, their positions and the speed multiplier. Everything else the map holds is derived and rebuilt on restore.
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		// scales every enemy's speed, enemies already on the map keep the speed they spawned with. Defaults to PATH_SPEED_MULTIPLIER.
+		// part of the simulation state: snapshots carry it and replays record it, so set it before game_t::start_recording.
+		void set_speed_multiplier(const float multiplier)
 		{
-			m_path_segments.front().add_enemy(enemy_instance_t{id, m_database->get(id).get_health()});
+			m_speed_multiplier = multiplier;
 		}
 
-		void draw(blt::gfx::batch_renderer_2d& renderer);
+		[[nodiscard]] float get_speed_multiplier() const
+		{
+			return m_speed_multiplier;
+		}
 
-		float update();
+		// when set, large enemy counts are advanced in parallel. The result is bit identical to the serial update.
+		void set_job_system(job_system_t* jobs)
+		{
+			m_jobs = jobs;
+		}
+
+		// when set, step() queues an enemy_leaked_event_t for every enemy reaching the end of the path, apply_damage() an enemy_died_event_t
+		// for every enemy killed
+		void set_event_bus(event_bus_t* events)
+		{
+			m_events = events;
+		}
 
 		[[nodiscard]] blt::gfx::curve2d_mesh_data_t get_mesh_data(float thickness = 1) const;
 
+		// mesh of the whole path, cached. Only rebuilt when thickness or PATH_DRAW_SEGMENTS differ from the cached mesh.
+		[[nodiscard]] const blt::gfx::curve2d_mesh_data_t& get_path_mesh(float thickness);
+
+		// position of the point distance units along the whole path
+		[[nodiscard]] blt::vec2 get_point(float distance) const;
+
+		void get_points(const float* distances, blt::vec2* points, blt::size_t count) const;
+
+		// index of the segment containing the distance along the path
+		[[nodiscard]] blt::size_t find_segment(float distance) const;
+
+		// enemies sorted by distance along the path, in increasing order. Rebuilt lazily after the enemies move.
+		[[nodiscard]] const std::vector<sorted_enemy_t>& get_sorted_view();
+
+		// targeting queries over the enemies with a distance inside [min_distance, max_distance].
+		// they return a dense index into get_enemies() or enemy_store_t::INVALID_INDEX if no enemy is in range.
+		// first is the enemy closest to leaking, last is the one furthest from it.
+		[[nodiscard]] blt::u32 find_first(float min_distance, float max_distance);
+
+		[[nodiscard]] blt::u32 find_last(float min_distance, float max_distance);
+
+		[[nodiscard]] blt::u32 find_strongest(float min_distance, float max_distance);
+
+		[[nodiscard]] const enemy_store_t& get_enemies() const
+		{
+			return m_enemies;
+		}
+
+		// world position of every enemy as of the last update, indexed like get_enemies()
+		[[nodiscard]] const std::vector<blt::vec2>& get_enemy_positions() const
+		{
+			return m_enemy_positions;
+		}
+
+		// spatial index over get_enemy_positions(), rebuilt at the end of every update
+		[[nodiscard]] const spatial_grid_t& get_enemy_grid() const
+		{
+			return m_enemy_grid;
+		}
+
+		[[nodiscard]] const std::vector<path_segment_t>& get_path_segments() const
+		{
+			return m_path_segments;
+		}
+
+		[[nodiscard]] float get_total_length() const
+		{
+			return m_segment_starts.back();
+		}
+
 	private:
+		// returns the sorted view range covering [min_distance, max_distance]
+		[[nodiscard]] std::pair<blt::size_t, blt::size_t> get_sorted_range(float min_distance, float max_distance);
+
+		// positions lag the store between a spawn and the next step, this computes the missing tail so they line up with dense indices again
+		void sync_positions();
+
 		std::vector<path_segment_t> m_path_segments;
+		// distance along the path at which each segment starts, the final entry is the total length of the path
+		std::vector<float> m_segment_starts;
 		enemy_database_t* m_database;
+		// copied per map so simulations running side by side can use different values
+		float m_speed_multiplier = PATH_SPEED_MULTIPLIER;
+		// every enemy on the map, keyed by the total distance they have travelled along the path
+		enemy_store_t m_enemies;
+		std::vector<sorted_enemy_t> m_sorted;
+		bool m_sorted_dirty = true;
+		// scratch list of enemies which reached the end of the path this update, kept to avoid allocating every frame
+		std::vector<blt::u32> m_crossed;
+		damage_resolver_t m_damage_resolver;
+		// scratch list of enemies killed by the last apply_damage()
+		std::vector<blt::u32> m_killed;
+		// children of the killed enemies, inserted into m_enemies as one batch
+		enemy_batch_t m_child_spawns;
+		enemy_batch_t m_wave_spawns;
+		// per chunk crossed lists of the parallel update, merged in chunk order so the result matches the serial update
+		std::vector<std::vector<blt::u32>> m_chunk_crossed;
+		job_system_t* m_jobs = nullptr;
+		event_bus_t* m_events = nullptr;
+		std::vector<blt::vec2> m_enemy_positions;
+		spatial_grid_t m_enemy_grid;
+		blt::gfx::curve2d_mesh_data_t m_path_mesh;
+		float m_path_mesh_thickness = 0;
+		// segment count the cached mesh was built with, 0 when nothing has been built yet
+		blt::i32 m_path_mesh_segments = 0;
 	};
 }
 
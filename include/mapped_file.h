@@ -0,0 +1,71 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <blt/std/types.h>
+#include <string>
+#include <vector>
+
+namespace td
+{
+	// read only view of a whole file. Memory mapped where the platform allows it, otherwise read into an owned buffer.
+	class mapped_file_t
+	{
+	public:
+		mapped_file_t() = default;
+
+		mapped_file_t(const mapped_file_t&) = delete;
+		mapped_file_t& operator=(const mapped_file_t&) = delete;
+
+		mapped_file_t(mapped_file_t&& move) noexcept;
+		mapped_file_t& operator=(mapped_file_t&& move) noexcept;
+
+		~mapped_file_t();
+
+		// maps the file at path, replacing anything already open. returns false if the file can't be opened.
+		bool open(const std::string& path);
+
+		void close();
+
+		[[nodiscard]] const void* data() const
+		{
+			return m_data;
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_size;
+		}
+
+		[[nodiscard]] bool is_open() const
+		{
+			return m_data != nullptr;
+		}
+
+	private:
+		const void* m_data = nullptr;
+		blt::size_t m_size = 0;
+		// true when m_data is a mapping which has to be unmapped, false when it points into m_fallback
+		bool m_mapped = false;
+		std::vector<blt::u32> m_fallback;
+	};
+}
+
+#endif //MAPPED_FILE_H
@@ -0,0 +1,161 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <events.h>
+#include <pool.h>
+#include <random.h>
+#include <sprite_instances.h>
+#include <blt/math/vectors.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	constexpr blt::size_t PARTICLE_CAPACITY = 1 << 18;
+
+	// a burst of particles thrown out in random directions from one point
+	struct particle_emitter_t
+	{
+		blt::u32 count;
+		float min_speed, max_speed;
+		float min_lifetime, max_lifetime;
+		float size;
+		float r, g, b;
+	};
+
+	// fixed capacity ring of particles, as structure of arrays inside one pool_block_t. New particles are written at the head, when the
+	// ring is full they replace the oldest. Particles which die before the ones older than them stay in the ring until the tail passes them
+	// and are skipped when drawing, so nothing is ever moved or allocated after construction.
+	class particle_pool_t
+	{
+	public:
+		explicit particle_pool_t(blt::size_t capacity = PARTICLE_CAPACITY);
+
+		particle_pool_t(const particle_pool_t&) = delete;
+		particle_pool_t& operator=(const particle_pool_t&) = delete;
+		particle_pool_t(particle_pool_t&&) = default;
+		particle_pool_t& operator=(particle_pool_t&&) = default;
+
+		void spawn(const blt::vec2& position, const blt::vec2& velocity, float lifetime, float size, float r, float g, float b);
+
+		// ages and moves every particle in the ring in one vectorised pass, slowing them down by drag, then drops dead particles off the tail
+		void step(float dt);
+
+		// appends a sprite for every live particle, shrinking and fading out over its lifetime
+		void write_instances(std::vector<sprite_instance_t>& instances, blt::u32 texture = NO_TEXTURE) const;
+
+		void clear()
+		{
+			m_tail = 0;
+			m_size = 0;
+		}
+
+		// particles in the ring, dead ones the tail hasn't reached yet included
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_size;
+		}
+
+		[[nodiscard]] blt::size_t capacity() const
+		{
+			return m_capacity;
+		}
+
+	private:
+		template <typename Func>
+		void for_each_span(Func&& func) const;
+
+		void step_span(blt::size_t begin, blt::size_t end, float dt, float damping);
+
+		blt::size_t m_capacity;
+		// index of the oldest particle, the ring holds [m_tail, m_tail + m_size) modulo the capacity
+		blt::size_t m_tail = 0;
+		blt::size_t m_size = 0;
+		pool_block_t m_block;
+		float* m_x = nullptr;
+		float* m_y = nullptr;
+		float* m_vx = nullptr;
+		float* m_vy = nullptr;
+		float* m_age = nullptr;
+		float* m_lifetime = nullptr;
+		float* m_sprite_size = nullptr;
+		float* m_r = nullptr;
+		float* m_g = nullptr;
+		float* m_b = nullptr;
+	};
+
+	// death bursts and hit sparks. Subscribes to a game's events and turns them into particles. Purely cosmetic, it never feeds back into the
+	// simulation so it is stepped with the frame time and is not part of snapshots or state hashes.
+	class particle_system_t
+	{
+	public:
+		explicit particle_system_t(blt::size_t capacity = PARTICLE_CAPACITY, blt::u64 seed = 0);
+
+		// the bus must outlive this system, and this system must not move once subscribed
+		void subscribe(event_bus_t& events);
+
+		void emit(const particle_emitter_t& emitter, const blt::vec2& position);
+
+		void step(const float dt)
+		{
+			m_pool.step(dt);
+		}
+
+		void write_instances(std::vector<sprite_instance_t>& instances) const
+		{
+			m_pool.write_instances(instances, m_texture);
+		}
+
+		// texture every particle sprite is drawn with, NO_TEXTURE by default
+		void set_texture(const blt::u32 texture)
+		{
+			m_texture = texture;
+		}
+
+		[[nodiscard]] particle_emitter_t& get_death_burst()
+		{
+			return m_death_burst;
+		}
+
+		[[nodiscard]] particle_emitter_t& get_hit_spark()
+		{
+			return m_hit_spark;
+		}
+
+		[[nodiscard]] const particle_pool_t& get_pool() const
+		{
+			return m_pool;
+		}
+
+	private:
+		void on_died(const enemy_died_event_t* events, blt::size_t count);
+
+		void on_hit(const projectile_hit_event_t* events, blt::size_t count);
+
+		particle_pool_t m_pool;
+		rng_t m_rng;
+		blt::u32 m_texture = NO_TEXTURE;
+		particle_emitter_t m_death_burst{24, 40, 160, 0.3f, 0.8f, 4, 1, 0.3f, 0.4f};
+		particle_emitter_t m_hit_spark{6, 60, 200, 0.1f, 0.25f, 2, 1, 0.9f, 0.4f};
+	};
+}
+
+#endif //PARTICLES_H
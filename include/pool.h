@@ -0,0 +1,83 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <blt/std/types.h>
+#include <memory>
+#include <new>
+
+namespace td
+{
+	// offsets of the arrays of a fixed capacity structure of arrays pool inside a single pool_block_t.
+	// every array starts on an ALIGNMENT byte boundary so the SIMD kernels never straddle a cache line more than they have to.
+	class pool_layout_t
+	{
+	public:
+		static constexpr blt::size_t ALIGNMENT = 64;
+
+		// returns the offset to pass to pool_block_t::get
+		template <typename T>
+		blt::size_t add(const blt::size_t count)
+		{
+			const auto offset = m_size;
+			m_size += (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			return offset;
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_size;
+		}
+
+	private:
+		blt::size_t m_size = 0;
+	};
+
+	// the one allocation backing a pool. Pools carve their arrays out of it at construction and never allocate again,
+	// spawning and removing elements only moves data around inside the block.
+	class pool_block_t
+	{
+	public:
+		pool_block_t() = default;
+
+		explicit pool_block_t(const pool_layout_t& layout):
+			m_data{static_cast<blt::u8*>(::operator new(layout.size(), std::align_val_t{pool_layout_t::ALIGNMENT}))}
+		{}
+
+		template <typename T>
+		[[nodiscard]] T* get(const blt::size_t offset) const
+		{
+			return reinterpret_cast<T*>(m_data.get() + offset);
+		}
+
+	private:
+		struct deleter_t
+		{
+			void operator()(blt::u8* data) const
+			{
+				::operator delete(data, std::align_val_t{pool_layout_t::ALIGNMENT});
+			}
+		};
+
+		std::unique_ptr<blt::u8, deleter_t> m_data;
+	};
+}
+
+#endif //POOL_H
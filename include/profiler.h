@@ -0,0 +1,99 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <blt/std/types.h>
+#include <string>
+#include <vector>
+
+namespace td::profiler
+{
+	// zones are only recorded when built with ENABLE_PROFILER (TD_PROFILE), otherwise TD_PROFILE_ZONE compiles to nothing
+	[[nodiscard]] constexpr bool is_enabled()
+	{
+#ifdef TD_PROFILE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// zones kept per thread. Older zones are overwritten, so end_frame() must run before a thread records this many in one frame.
+	// a zone overwritten while end_frame() or write_chrome_trace() is copying it is skipped.
+	constexpr blt::size_t ZONES_PER_THREAD = 16384;
+	// frames the rolling statistics are taken over
+	constexpr blt::size_t FRAME_HISTORY = 120;
+
+	struct zone_stats_t
+	{
+		// the name the zone was recorded with. Zones with equal names are merged, the name must outlive the profiler so use string literals
+		const char* name;
+		// time spent in the zone per frame, summed over every thread and every time the zone was entered
+		double last_ms;
+		double average_ms;
+		double max_ms;
+	};
+
+	// nanoseconds since the profiler was first used, monotonic
+	[[nodiscard]] blt::u64 now_ns();
+
+	// appends a finished zone to the calling thread's ring buffer. No locks, each thread only ever writes its own buffer.
+	void record(const char* name, blt::u64 start_ns, blt::u64 end_ns);
+
+	// folds everything recorded since the last call into the rolling statistics. Call once per frame, always from the same thread.
+	void end_frame();
+
+	// in the order zones were first seen
+	[[nodiscard]] const std::vector<zone_stats_t>& get_stats();
+
+	// writes every zone still held in the thread buffers as a chrome://tracing / Perfetto JSON trace
+	bool write_chrome_trace(const std::string& path);
+
+	// records the time between construction and destruction
+	class zone_t
+	{
+	public:
+		explicit zone_t(const char* name): m_name{name}, m_start{now_ns()}
+		{}
+
+		zone_t(const zone_t&) = delete;
+		zone_t& operator=(const zone_t&) = delete;
+
+		~zone_t()
+		{
+			record(m_name, m_start, now_ns());
+		}
+
+	private:
+		const char* m_name;
+		blt::u64 m_start;
+	};
+}
+
+#define TD_PROFILE_CONCAT_IMPL(a, b) a##b
+#define TD_PROFILE_CONCAT(a, b) TD_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef TD_PROFILE
+	#define TD_PROFILE_ZONE(name) const td::profiler::zone_t TD_PROFILE_CONCAT(td_profile_zone_, __LINE__){name}
+#else
+	#define TD_PROFILE_ZONE(name)
+#endif
+
+#endif //PROFILER_H
@@ -0,0 +1,153 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include <damage.h>
+#include <events.h>
+#include <hash.h>
+#include <pool.h>
+#include <snapshot.h>
+#include <spatial_grid.h>
+#include <sprite_instances.h>
+#include <fwddecl.h>
+#include <blt/math/vectors.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// enough for 100k projectiles in flight with room to spare
+	constexpr blt::size_t PROJECTILE_CAPACITY = 1 << 17;
+	// enemies collide as circles of this radius, half the size they are drawn at
+	constexpr float ENEMY_RADIUS = 5;
+
+	struct projectile_t
+	{
+		blt::vec2 position;
+		// units per second
+		blt::vec2 velocity;
+		// seconds until the projectile is removed without hitting anything
+		float lifetime;
+		float damage;
+		float radius;
+		// damage_type_t mask
+		blt::u8 damage_mask;
+	};
+
+	// fixed capacity structure of arrays pool of projectiles. Every array lives in one block allocated at construction, the live projectiles
+	// are kept dense and removing one moves the last projectile into its slot.
+	class projectile_pool_t
+	{
+	public:
+		explicit projectile_pool_t(blt::size_t capacity = PROJECTILE_CAPACITY);
+
+		projectile_pool_t(const projectile_pool_t&) = delete;
+		projectile_pool_t& operator=(const projectile_pool_t&) = delete;
+		projectile_pool_t(projectile_pool_t&&) = default;
+		projectile_pool_t& operator=(projectile_pool_t&&) = default;
+
+		// returns false and drops the projectile when the pool is full
+		bool spawn(const projectile_t& projectile);
+
+		// moves every projectile over dt in one vectorised pass, then sweeps each projectile's circle along the distance it just moved and
+		// tests it against the enemies near that sweep. A projectile hits the first enemy it touches, appends
+		// a hit and is removed. Projectiles whose lifetime ran out are removed as well. Enemies are taken as of the map's last step.
+		// when events is set a projectile_hit_event_t is queued for every hit.
+		void step(float dt, const map_t& map, std::vector<hit_t>& hits, event_bus_t* events = nullptr);
+
+		void clear()
+		{
+			m_size = 0;
+		}
+
+		void write_instances(std::vector<sprite_instance_t>& instances) const;
+
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		// adds the live projectiles to a state hash
+		void add_to_hash(fnv1a_t& hash) const;
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_size;
+		}
+
+		[[nodiscard]] blt::size_t capacity() const
+		{
+			return m_capacity;
+		}
+
+		[[nodiscard]] bool empty() const
+		{
+			return m_size == 0;
+		}
+
+		// the arrays are size() long
+		[[nodiscard]] const float* get_x() const
+		{
+			return m_x;
+		}
+
+		[[nodiscard]] const float* get_y() const
+		{
+			return m_y;
+		}
+
+		[[nodiscard]] const float* get_lifetimes() const
+		{
+			return m_lifetime;
+		}
+
+	private:
+		// moves the projectiles and appends the index of every projectile whose lifetime ran out to m_expired
+		void integrate(float dt);
+
+		// appends the index of every projectile which hit an enemy to m_collided
+		void collide(float dt, const map_t& map, std::vector<hit_t>& hits, event_bus_t* events);
+
+		void remove(blt::size_t index);
+
+		template <typename Func>
+		void for_each_array(Func&& func) const;
+
+		blt::size_t m_capacity;
+		blt::size_t m_size = 0;
+		pool_block_t m_block;
+		float* m_x = nullptr;
+		float* m_y = nullptr;
+		float* m_vx = nullptr;
+		float* m_vy = nullptr;
+		float* m_lifetime = nullptr;
+		float* m_damage = nullptr;
+		float* m_radius = nullptr;
+		blt::u8* m_damage_mask = nullptr;
+		// scratch lists of the last step, both in increasing order
+		std::vector<blt::u32> m_expired;
+		std::vector<blt::u32> m_collided;
+		std::vector<blt::u32> m_removed;
+		// broadphase over the enemy positions. Projectile sweeps are a lot smaller than tower ranges, so a finer grid than the map's
+		// keeps the candidates per projectile down to the enemies actually nearby.
+		spatial_grid_t m_enemy_grid;
+	};
+}
+
+#endif //PROJECTILES_H
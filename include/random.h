@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <blt/std/types.h>
+
+namespace td
+{
+	// small seeded generator (pcg32) for everything the simulation randomises. Only integer operations produce its state,
+	// so the same seed gives the same sequence on every platform and compiler, unlike the standard library distributions.
+	class rng_t
+	{
+	public:
+		explicit rng_t(const blt::u64 seed = 0)
+		{
+			reseed(seed);
+		}
+
+		void reseed(const blt::u64 seed)
+		{
+			m_state = 0;
+			next_u32();
+			m_state += seed;
+			next_u32();
+		}
+
+		blt::u32 next_u32()
+		{
+			const auto old = m_state;
+			m_state = old * 6364136223846793005ull + INCREMENT;
+			const auto shifted = static_cast<blt::u32>(((old >> 18u) ^ old) >> 27u);
+			const auto rotation = static_cast<blt::u32>(old >> 59u);
+			return (shifted >> rotation) | (shifted << ((32 - rotation) & 31));
+		}
+
+		// uniform in [0, 1), built from the top 24 bits so every value is exactly representable
+		float next_float()
+		{
+			return static_cast<float>(next_u32() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		float next_float(const float min, const float max)
+		{
+			return min + (max - min) * next_float();
+		}
+
+		// uniform in [0, bound), bound must not be zero
+		blt::u32 next_u32(const blt::u32 bound)
+		{
+			// rejection keeps the result unbiased
+			const auto threshold = (0u - bound) % bound;
+			while (true)
+			{
+				const auto value = next_u32();
+				if (value >= threshold)
+					return value % bound;
+			}
+		}
+
+		[[nodiscard]] blt::u64 get_state() const
+		{
+			return m_state;
+		}
+
+		void set_state(const blt::u64 state)
+		{
+			m_state = state;
+		}
+
+	private:
+		static constexpr blt::u64 INCREMENT = 1442695040888963407ull;
+
+		blt::u64 m_state = 0;
+	};
+}
+
+#endif //RANDOM_H
@@ -0,0 +1,109 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <map.h>
+#include <towers.h>
+#include <waves.h>
+#include <blt/std/types.h>
+#include <string>
+#include <vector>
+
+namespace td
+{
+	enum class input_type_t : blt::u32
+	{
+		START_WAVE,
+		PLACE_TOWER
+	};
+
+	struct tower_placement_t
+	{
+		tower_id_t type;
+		float x, y;
+	};
+
+	// something the player did. Inputs are the only thing a replay stores, everything else is re-simulated from them.
+	// fixed size so a replay can be written and read as a flat array.
+	struct input_t
+	{
+		// tick the input was applied on, filled in by game_t::queue_input
+		blt::u64 tick = 0;
+		input_type_t type = input_type_t::START_WAVE;
+		// START_WAVE
+		wave_t wave{};
+		// PLACE_TOWER
+		tower_placement_t tower{};
+	};
+
+	// fields are ordered so the record has no padding, every byte written to a replay is initialised
+	static_assert(sizeof(input_t) == 40, "input_t is part of the replay format");
+
+	// state hash taken after a tick, used to check a re-simulation hasn't diverged
+	struct replay_checkpoint_t
+	{
+		blt::u64 tick;
+		blt::u64 hash;
+	};
+
+	struct replay_t
+	{
+		static constexpr blt::u32 MAGIC = 0x59504454; // "TDPY"
+		static constexpr blt::u32 VERSION = 4;
+
+		blt::u64 seed = 0;
+		// enemy_database_t::compute_hash() of the definitions the game was recorded with
+		blt::u64 database_hash = 0;
+		// map_t::get_speed_multiplier() of the recorded game, applied to the fresh game before re-simulating
+		float speed_multiplier = PATH_SPEED_MULTIPLIER;
+		float tick_length = 0;
+		// a checkpoint is taken every hash_interval ticks
+		blt::u32 hash_interval = 0;
+		// in the order they were applied, so ticks never decrease
+		std::vector<input_t> inputs;
+		std::vector<replay_checkpoint_t> checkpoints;
+
+		bool write(const std::string& path) const;
+
+		// returns false and leaves the replay untouched if the file is missing, not a replay or holds an input naming an unknown enemy or tower
+		bool read(const std::string& path);
+	};
+
+	struct replay_result_t
+	{
+		// ticks simulated, up to and including the last checkpoint
+		blt::u64 ticks = 0;
+		// first tick whose hash didn't match the recording, or ~0 if every checkpoint matched
+		blt::u64 mismatch_tick = ~0ull;
+		// false if the replay was recorded with different enemy definitions, nothing is simulated in that case
+		bool database_matched = true;
+
+		[[nodiscard]] bool matched() const
+		{
+			return database_matched && mismatch_tick == ~0ull;
+		}
+	};
+
+	// re-simulates the replay on a fresh game as fast as possible, checking the state hash at every checkpoint.
+	// the fresh game uses the built in enemy definitions, a replay recorded with different definitions is rejected before simulating.
+	replay_result_t play_replay(const replay_t& replay, const std::vector<path_segment_t>& path_segments, job_system_t* jobs = nullptr);
+}
+
+#endif //REPLAY_H
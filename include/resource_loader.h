@@ -0,0 +1,169 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOURCE_LOADER_H
+#define RESOURCE_LOADER_H
+
+#include <image.h>
+#include <blt/std/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace td
+{
+	enum class resource_priority_t : blt::u8
+	{
+		// needed before the first frame, see resource_loader_t::finish_critical
+		CRITICAL,
+		// streamed in while the game runs
+		STREAMED
+	};
+
+	// loads images in two halves. Decoding runs on the loader's own threads, critical resources first, and uploading runs on the thread
+	// calling upload(), which for textures is the one owning the GL context. upload() stops once its time budget is spent, so streaming
+	// assets in costs a frame a bounded amount of time. Both halves are plain function pointers, the loader knows nothing about files
+	// or GL, which keeps it usable without a window.
+	class resource_loader_t
+	{
+	public:
+		// called on a decode thread, returns false if the resource couldn't be loaded
+		using decode_func_t = bool(*)(void* context, const std::string& path, image_t& image);
+		// called on the thread calling upload() or finish_critical()
+		using upload_func_t = void(*)(void* context, const std::string& name, const image_t& image);
+
+		// with thread_count 0 images are decoded inside upload() instead, on the calling thread
+		resource_loader_t(decode_func_t decode, upload_func_t upload, void* context = nullptr, blt::size_t thread_count = default_thread_count());
+
+		~resource_loader_t();
+
+		resource_loader_t(const resource_loader_t&) = delete;
+		resource_loader_t& operator=(const resource_loader_t&) = delete;
+
+		// everything must be enqueued before start()
+		void enqueue(std::string path, std::string name, resource_priority_t priority = resource_priority_t::STREAMED);
+
+		// starts the decode threads. upload(), finish_critical() and finish() call it if it hasn't been called yet.
+		void start();
+
+		// uploads decoded images until budget_ns has passed, at least one if any is ready. Returns the number of images handled.
+		blt::size_t upload(blt::u64 budget_ns);
+
+		// blocks until every critical resource has been uploaded. Streamed resources decoded by then are uploaded as well.
+		void finish_critical();
+
+		// blocks until everything has been uploaded
+		void finish();
+
+		[[nodiscard]] blt::size_t get_total() const
+		{
+			return m_requests.size();
+		}
+
+		// images decoded so far, failures included. Safe to read from any thread.
+		[[nodiscard]] blt::size_t get_decoded() const
+		{
+			return m_decoded_count.load(std::memory_order_relaxed);
+		}
+
+		// images uploaded or given up on so far
+		[[nodiscard]] blt::size_t get_uploaded() const
+		{
+			return m_uploaded;
+		}
+
+		[[nodiscard]] float get_progress() const
+		{
+			return m_requests.empty() ? 1.0f : static_cast<float>(m_uploaded) / static_cast<float>(m_requests.size());
+		}
+
+		[[nodiscard]] bool is_critical_done() const
+		{
+			return m_critical_uploaded == m_critical_count;
+		}
+
+		[[nodiscard]] bool is_done() const
+		{
+			return m_uploaded == m_requests.size();
+		}
+
+		// paths of the resources which failed to decode
+		[[nodiscard]] const std::vector<std::string>& get_failures() const
+		{
+			return m_failures;
+		}
+
+		static blt::size_t default_thread_count()
+		{
+			const auto hardware = std::thread::hardware_concurrency();
+			return hardware > 1 ? hardware - 1 : 1;
+		}
+
+	private:
+		struct request_t
+		{
+			std::string path;
+			std::string name;
+			resource_priority_t priority;
+		};
+
+		struct decoded_t
+		{
+			blt::u32 request;
+			bool ok;
+			image_t image;
+		};
+
+		// claims the next request and decodes it, false once every request has been claimed
+		bool decode_next();
+
+		// uploads one decoded image, refilling the upload list from the decode threads when it runs out. False if nothing was ready.
+		bool upload_next();
+
+		// uploads whatever is ready, then waits for the decode threads to produce more
+		void wait_for_decode();
+
+		void worker_main();
+
+		decode_func_t m_decode;
+		upload_func_t m_upload;
+		void* m_context;
+		blt::size_t m_thread_count;
+		std::vector<request_t> m_requests;
+		blt::size_t m_critical_count = 0;
+		std::atomic<blt::size_t> m_next{0};
+		std::atomic<blt::size_t> m_decoded_count{0};
+		// handed over from the decode threads, guarded by m_mutex
+		std::mutex m_mutex;
+		std::condition_variable m_decoded_cv;
+		std::vector<decoded_t> m_decoded;
+		// owned by the uploading thread
+		std::vector<decoded_t> m_uploading;
+		blt::size_t m_upload_index = 0;
+		blt::size_t m_uploaded = 0;
+		blt::size_t m_critical_uploaded = 0;
+		std::vector<std::string> m_failures;
+		std::vector<std::thread> m_threads;
+		bool m_started = false;
+	};
+}
+
+#endif //RESOURCE_LOADER_H
@@ -0,0 +1,53 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <blt/std/types.h>
+#include <vector>
+
+// picks the widest instruction set the simulation kernels may use. AVX needs ENABLE_NATIVE_ARCH (or equivalent flags),
+// SSE2 is always there on x86-64. Everything else falls back to the scalar loops.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TD_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TD_SIMD_SSE
+#endif
+
+namespace td::simd
+{
+	// every kernel processes this many floats per iteration, as one AVX register or two SSE registers
+	constexpr blt::u32 LANES = 8;
+
+	// appends base + i for every set bit i of an 8 lane movemask
+	inline void append_mask_indices(const int mask, const blt::u32 base, std::vector<blt::u32>& out)
+	{
+		if (mask == 0)
+			return;
+		for (blt::u32 i = 0; i < LANES; ++i)
+		{
+			if (mask & (1 << i))
+				out.push_back(base + i);
+		}
+	}
+}
+
+#endif //SIMD_H
@@ -0,0 +1,118 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <blt/std/types.h>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace td
+{
+	// simulation state is written as a flat sequence of trivially copyable values and arrays. Arrays are a count followed by the raw
+	// elements, so saving and restoring the structure of arrays stores is a memcpy per array.
+	class snapshot_writer_t
+	{
+	public:
+		explicit snapshot_writer_t(std::vector<blt::u8>& buffer): m_buffer(buffer)
+		{}
+
+		template <typename T>
+		void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			write_bytes(&value, sizeof(T));
+		}
+
+		template <typename T>
+		void write(const std::vector<T>& values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			write(static_cast<blt::u64>(values.size()));
+			write_bytes(values.data(), values.size() * sizeof(T));
+		}
+
+		void write_bytes(const void* data, const blt::size_t size)
+		{
+			const auto offset = m_buffer.size();
+			m_buffer.resize(offset + size);
+			if (size != 0)
+				std::memcpy(m_buffer.data() + offset, data, size);
+		}
+
+	private:
+		std::vector<blt::u8>& m_buffer;
+	};
+
+	// reads back what a snapshot_writer_t wrote. Every read is bounds checked, once one fails every later read fails too.
+	class snapshot_reader_t
+	{
+	public:
+		snapshot_reader_t(const blt::u8* data, const blt::size_t size): m_data(data), m_size(size)
+		{}
+
+		template <typename T>
+		bool read(T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return read_bytes(&value, sizeof(T));
+		}
+
+		// reuses the vector's storage, restoring into the same containers again doesn't allocate
+		template <typename T>
+		bool read(std::vector<T>& values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			blt::u64 count = 0;
+			if (!read(count) || count > (m_size - m_offset) / sizeof(T))
+				return m_good = false;
+			values.resize(count);
+			return read_bytes(values.data(), count * sizeof(T));
+		}
+
+		bool read_bytes(void* data, const blt::size_t size)
+		{
+			if (!m_good || size > m_size - m_offset)
+				return m_good = false;
+			if (size != 0)
+				std::memcpy(data, m_data + m_offset, size);
+			m_offset += size;
+			return true;
+		}
+
+		[[nodiscard]] bool good() const
+		{
+			return m_good;
+		}
+
+		[[nodiscard]] blt::size_t remaining() const
+		{
+			return m_size - m_offset;
+		}
+
+	private:
+		const blt::u8* m_data;
+		blt::size_t m_size;
+		blt::size_t m_offset = 0;
+		bool m_good = true;
+	};
+}
+
+#endif //SNAPSHOT_H
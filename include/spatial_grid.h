@@ -0,0 +1,155 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <bounding_box.h>
+#include <blt/math/vectors.h>
+#include <blt/std/types.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace td
+{
+	// uniform grid over a wrapping (toroidal) table of buckets, rebuilt from scratch every tick with a counting sort.
+	// cells which are a whole table width apart share a bucket, queries always test the exact position so this only costs
+	// extra comparisons, never wrong results. Entry ids are indices into the position array the grid was built from.
+	class spatial_grid_t
+	{
+	public:
+		// the table is (1 << table_bits) buckets along each axis
+		explicit spatial_grid_t(float cell_size = 64, blt::u32 table_bits = 6);
+
+		void rebuild(const blt::vec2* positions, blt::size_t count);
+
+		void rebuild(const std::vector<blt::vec2>& positions)
+		{
+			rebuild(positions.data(), positions.size());
+		}
+
+		// appends the id of every entry within radius of center to out
+		void query_radius(const blt::vec2& center, float radius, std::vector<blt::u32>& out) const
+		{
+			for_each_in_radius(center, radius, [&out](const blt::u32 id) {
+				out.push_back(id);
+			});
+		}
+
+		// appends the id of every entry inside box to out
+		void query_box(const bounding_box_t& box, std::vector<blt::u32>& out) const
+		{
+			for_each_in_box(box, [&out](const blt::u32 id) {
+				out.push_back(id);
+			});
+		}
+
+		template <typename Func>
+		void for_each_in_radius(const blt::vec2& center, const float radius, Func&& func) const
+		{
+			const auto radius_sq = radius * radius;
+			const auto cx = center.x();
+			const auto cy = center.y();
+			for_each_bucket(cx - radius, cy - radius, cx + radius, cy + radius, [&](const blt::u32 begin, const blt::u32 end) {
+				for (auto i = begin; i < end; ++i)
+				{
+					const auto dx = m_x[i] - cx;
+					const auto dy = m_y[i] - cy;
+					if (dx * dx + dy * dy <= radius_sq)
+						func(m_entries[i]);
+				}
+			});
+		}
+
+		template <typename Func>
+		void for_each_in_box(const bounding_box_t& box, Func&& func) const
+		{
+			const auto min = box.get_min();
+			const auto max = box.get_max();
+			for_each_bucket(min.x(), min.y(), max.x(), max.y(), [&](const blt::u32 begin, const blt::u32 end) {
+				for (auto i = begin; i < end; ++i)
+				{
+					if (m_x[i] >= min.x() && m_x[i] <= max.x() && m_y[i] >= min.y() && m_y[i] <= max.y())
+						func(m_entries[i]);
+				}
+			});
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_entries.size();
+		}
+
+		[[nodiscard]] float get_cell_size() const
+		{
+			return m_cell_size;
+		}
+
+	private:
+		[[nodiscard]] blt::i32 cell_of(const float value) const
+		{
+			return static_cast<blt::i32>(std::floor(value * m_inv_cell_size));
+		}
+
+		[[nodiscard]] blt::u32 bucket_of(const blt::i32 x, const blt::i32 y) const
+		{
+			return (static_cast<blt::u32>(x) & m_axis_mask) | ((static_cast<blt::u32>(y) & m_axis_mask) << m_table_bits);
+		}
+
+		// calls func with the entry range of every bucket overlapping the area, visiting each bucket at most once
+		template <typename Func>
+		void for_each_bucket(const float min_x, const float min_y, const float max_x, const float max_y, Func&& func) const
+		{
+			if (m_entries.empty())
+				return;
+			const auto x0 = cell_of(min_x);
+			const auto y0 = cell_of(min_y);
+			// once the area spans the whole table every bucket has been covered, further cells would only revisit them
+			const auto axis_size = static_cast<blt::i32>(m_axis_mask + 1);
+			const auto x1 = std::min(cell_of(max_x), x0 + axis_size - 1);
+			const auto y1 = std::min(cell_of(max_y), y0 + axis_size - 1);
+			for (auto y = y0; y <= y1; ++y)
+			{
+				for (auto x = x0; x <= x1; ++x)
+				{
+					const auto bucket = bucket_of(x, y);
+					const auto begin = m_bucket_start[bucket];
+					const auto end = m_bucket_start[bucket + 1];
+					if (begin != end)
+						func(begin, end);
+				}
+			}
+		}
+
+		float m_cell_size;
+		float m_inv_cell_size;
+		blt::u32 m_table_bits;
+		blt::u32 m_axis_mask;
+		// entries of bucket b are [m_bucket_start[b], m_bucket_start[b + 1])
+		std::vector<blt::u32> m_bucket_start;
+		// ids and positions in bucket order, so a bucket scan reads contiguous memory
+		std::vector<blt::u32> m_entries;
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		// bucket of every input position, scratch for rebuild
+		std::vector<blt::u32> m_buckets;
+	};
+}
+
+#endif //SPATIAL_GRID_H
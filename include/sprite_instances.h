@@ -0,0 +1,72 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPRITE_INSTANCES_H
+#define SPRITE_INSTANCES_H
+
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// texture index of a sprite drawn as a flat coloured quad
+	constexpr blt::u32 NO_TEXTURE = ~0u;
+
+	// one sprite as consumed by the instanced renderer. The layout is uploaded as is, so it must stay plain data.
+	struct sprite_instance_t
+	{
+		// center of the sprite in world space
+		float x, y;
+		float size;
+		// layer of the renderer's texture array, tinted by the colour. Enemies use the interned index from
+		// enemy_database_t::get_texture_index, NO_TEXTURE draws the colour alone.
+		blt::u32 texture;
+		float r, g, b, a;
+	};
+
+	// double buffered instance storage. The simulation fills the back buffer and publishes it, the renderer only ever reads the
+	// front buffer. Both buffers keep their capacity so steady state frames never allocate.
+	class sprite_instance_buffer_t
+	{
+	public:
+		// clears and returns the back buffer
+		std::vector<sprite_instance_t>& begin_write()
+		{
+			auto& back = m_buffers[1 - m_front];
+			back.clear();
+			return back;
+		}
+
+		// makes the back buffer the one returned by get_front()
+		void publish()
+		{
+			m_front = 1 - m_front;
+		}
+
+		[[nodiscard]] const std::vector<sprite_instance_t>& get_front() const
+		{
+			return m_buffers[m_front];
+		}
+
+	private:
+		std::vector<sprite_instance_t> m_buffers[2];
+		blt::size_t m_front = 0;
+	};
+}
+
+#endif //SPRITE_INSTANCES_H
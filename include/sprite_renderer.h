@@ -0,0 +1,64 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPRITE_RENDERER_H
+#define SPRITE_RENDERER_H
+
+#include <image.h>
+#include <sprite_instances.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	// draws every sprite of an instance buffer with a single instanced draw call.
+	// sprites are quads in world space, transformed by the same global matrices as batch_renderer_2d. Every texture lives in one
+	// layer of a texture array so a single draw can mix them, a sprite's texture index picks the layer and its colour tints it.
+	class sprite_renderer_t
+	{
+	public:
+		static constexpr blt::u32 MAX_TEXTURES = 64;
+		// width and height of every layer, images are resampled to fit
+		static constexpr blt::u32 TEXTURE_SIZE = 64;
+
+		// must be called with a current GL context, like batch_renderer_2d::create. Every layer starts out white.
+		void create();
+
+		// replaces a layer with the image, which may have 1 (grey), 2 (grey, alpha), 3 or 4 channels.
+		// returns false if the layer is out of range or the image is empty.
+		bool set_texture(blt::u32 layer, const image_t& image);
+
+		// global_matrices must have been updated for the frame
+		void render(const std::vector<sprite_instance_t>& instances);
+
+		void cleanup();
+
+	private:
+		blt::u32 m_program = 0;
+		blt::u32 m_vao = 0;
+		blt::u32 m_quad_vbo = 0;
+		blt::u32 m_instance_vbo = 0;
+		blt::u32 m_texture_array = 0;
+		// one layer of rgba pixels, reused by every set_texture call
+		std::vector<blt::u8> m_layer_pixels;
+		// size of the instance vbo in sprites, it only grows
+		blt::size_t m_capacity = 0;
+	};
+}
+
+#endif //SPRITE_RENDERER_H
@@ -0,0 +1,167 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TARGETING_H
+#define TARGETING_H
+
+#include <map.h>
+#include <blt/math/vectors.h>
+#include <blt/std/types.h>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace td
+{
+	// how a tower picks between the enemies in its range. Each value maps to one of the policies below.
+	enum class targeting_t : blt::u8
+	{
+		// closest to leaking
+		FIRST,
+		// furthest from leaking
+		LAST,
+		// most health left
+		STRONGEST,
+		// closest to the tower
+		CLOSEST
+	};
+
+	bool parse_targeting(std::string_view name, targeting_t& targeting);
+
+	// a stretch of the path, as distances along it
+	struct path_interval_t
+	{
+		float min_distance;
+		float max_distance;
+	};
+
+	// appends the stretches of the path passing within range of center, in increasing order and without overlap.
+	// the intervals are conservative: an enemy inside one may still be out of range, an enemy outside all of them never is.
+	void find_path_coverage(const map_t& map, const blt::vec2& center, float range, std::vector<path_interval_t>& intervals);
+
+	// what the policies look at, valid until the enemies next change
+	struct targeting_view_t
+	{
+		const map_t::sorted_enemy_t* sorted;
+		blt::size_t count;
+		// indexed by dense enemy index
+		const blt::vec2* positions;
+		const float* health;
+	};
+
+	[[nodiscard]] targeting_view_t make_targeting_view(map_t& map);
+
+	struct target_query_t
+	{
+		blt::vec2 center;
+		float range_squared;
+		// from find_path_coverage()
+		const path_interval_t* intervals;
+		blt::u32 interval_count;
+	};
+
+	// targeting policies. A policy says which way to walk the sorted view and either takes the first enemy in range (TAKE_FIRST) or the
+	// one with the highest score. Scores are only compared within one policy.
+	struct target_first_t
+	{
+		static constexpr bool REVERSE = true;
+		static constexpr bool TAKE_FIRST = true;
+
+		static float score(const targeting_view_t&, blt::u32, float)
+		{
+			return 0;
+		}
+	};
+
+	struct target_last_t
+	{
+		static constexpr bool REVERSE = false;
+		static constexpr bool TAKE_FIRST = true;
+
+		static float score(const targeting_view_t&, blt::u32, float)
+		{
+			return 0;
+		}
+	};
+
+	struct target_strongest_t
+	{
+		// ties go to the enemy further along the path
+		static constexpr bool REVERSE = true;
+		static constexpr bool TAKE_FIRST = false;
+
+		static float score(const targeting_view_t& view, const blt::u32 enemy, float)
+		{
+			return view.health[enemy];
+		}
+	};
+
+	struct target_closest_t
+	{
+		static constexpr bool REVERSE = true;
+		static constexpr bool TAKE_FIRST = false;
+
+		static float score(const targeting_view_t&, blt::u32, const float distance_squared)
+		{
+			return -distance_squared;
+		}
+	};
+
+	// returns the dense index of the enemy Policy picks for the query, or enemy_store_t::INVALID_INDEX if nothing is in range.
+	// every path interval is a binary search into the sorted view followed by a scan of the enemies inside it.
+	template <typename Policy>
+	blt::u32 find_target(const targeting_view_t& view, const target_query_t& query)
+	{
+		const auto* sorted_begin = view.sorted;
+		const auto* sorted_end = view.sorted + view.count;
+		auto best = enemy_store_t::INVALID_INDEX;
+		float best_score = 0;
+		for (blt::u32 k = 0; k < query.interval_count; ++k)
+		{
+			const auto& interval = query.intervals[Policy::REVERSE ? query.interval_count - 1 - k : k];
+			const auto* begin = std::lower_bound(sorted_begin, sorted_end, interval.min_distance,
+												[](const map_t::sorted_enemy_t& a, const float value) {
+													return a.distance < value;
+												});
+			const auto* end = std::upper_bound(begin, sorted_end, interval.max_distance, [](const float value, const map_t::sorted_enemy_t& a) {
+				return value < a.distance;
+			});
+			const auto count = end - begin;
+			for (std::ptrdiff_t i = 0; i < count; ++i)
+			{
+				const auto enemy = (Policy::REVERSE ? end[-1 - i] : begin[i]).index;
+				const auto dx = view.positions[enemy].x() - query.center.x();
+				const auto dy = view.positions[enemy].y() - query.center.y();
+				const auto distance_squared = dx * dx + dy * dy;
+				if (distance_squared > query.range_squared)
+					continue;
+				if constexpr (Policy::TAKE_FIRST)
+					return enemy;
+				const auto score = Policy::score(view, enemy, distance_squared);
+				if (best == enemy_store_t::INVALID_INDEX || score > best_score)
+				{
+					best = enemy;
+					best_score = score;
+				}
+			}
+		}
+		return best;
+	}
+}
+
+#endif //TARGETING_H
@@ -19,11 +19,201 @@
 #ifndef TOWERS_H
 #define TOWERS_H
 
+#include <damage.h>
+#include <events.h>
+#include <map.h>
+#include <projectiles.h>
+#include <snapshot.h>
+#include <sprite_instances.h>
+#include <targeting.h>
+#include <blt/math/vectors.h>
+#include <blt/std/types.h>
+#include <string_view>
+#include <vector>
+
 namespace td
 {
-	class tower_base_t
+	// tower archetypes. If you add more you must register them in tower_system_t.
+	enum class tower_id_t : blt::u32
+	{
+		BASIC,
+		SNIPER,
+		LOVE
+	};
+
+	// number of tower_id_t values
+	constexpr blt::u32 TOWER_ID_COUNT = 3;
+
+	// the names towers go by in text sources
+	bool parse_tower_id(std::string_view name, tower_id_t& id);
+
+	// what a newly placed tower of an archetype starts with
+	struct tower_stats_t
+	{
+		float range;
+		// seconds between shots
+		float fire_interval;
+		float damage;
+		// damage_type_t mask
+		blt::u8 damage_mask;
+		targeting_t targeting;
+		// units per second of the projectiles fired, 0 hits the target the moment the tower fires
+		float projectile_speed;
+	};
+
+	// every tower of one archetype, as structure of arrays. Towers are never moved once placed, so an index stays valid.
+	class tower_archetype_t
+	{
+	public:
+		explicit tower_archetype_t(const tower_stats_t& stats): m_stats{stats}
+		{}
+
+		// returns the index of the new tower
+		blt::u32 add(blt::u32 id, const blt::vec2& position);
+
+		// subtracts dt from every cooldown and appends the index of every tower whose cooldown has run out
+		void tick_cooldowns(float dt, std::vector<blt::u32>& ready);
+
+		// picks a target for every ready tower using the archetype's targeting policy. Each tower which found one either appends a hit or,
+		// when the archetype has a projectile speed, launches a projectile at the target's current position. Towers without a target stay ready.
+		void fire(const std::vector<blt::u32>& ready, map_t& map, std::vector<hit_t>& hits, projectile_pool_t& projectiles, event_bus_t* events);
+
+		void write_instances(std::vector<sprite_instance_t>& instances, blt::u32 texture) const;
+
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		[[nodiscard]] const tower_stats_t& get_stats() const
+		{
+			return m_stats;
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_ids.size();
+		}
+
+		[[nodiscard]] const std::vector<blt::u32>& get_ids() const
+		{
+			return m_ids;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_x() const
+		{
+			return m_x;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_y() const
+		{
+			return m_y;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_range_squared() const
+		{
+			return m_range_squared;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_cooldowns() const
+		{
+			return m_cooldown;
+		}
+
+		[[nodiscard]] const std::vector<float>& get_damage() const
+		{
+			return m_damage;
+		}
+
+		[[nodiscard]] const std::vector<blt::u8>& get_damage_masks() const
+		{
+			return m_damage_mask;
+		}
+
+		// stretches of the path in range of the tower at index, see find_path_coverage()
+		[[nodiscard]] const path_interval_t* get_coverage(const blt::u32 index, blt::u32& count) const
+		{
+			count = m_coverage_count[index];
+			return m_coverage.data() + m_coverage_first[index];
+		}
+
+	private:
+		// launches a projectile from the tower at index towards target, false if the archetype hits instantly or the pool is full
+		bool launch(blt::u32 index, const blt::vec2& target, projectile_pool_t& projectiles) const;
+
+		// finds the coverage of towers placed since the last call
+		void update_coverage(const map_t& map);
+
+		template <typename Policy>
+		void fire(const std::vector<blt::u32>& ready, const targeting_view_t& view, const enemy_store_t& enemies, std::vector<hit_t>& hits,
+				  projectile_pool_t& projectiles, event_bus_t* events);
+
+		tower_stats_t m_stats;
+		// id given out by tower_system_t, unique across archetypes
+		std::vector<blt::u32> m_ids;
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		std::vector<float> m_range_squared;
+		// seconds until the tower can fire, at or below zero means ready
+		std::vector<float> m_cooldown;
+		std::vector<float> m_damage;
+		std::vector<blt::u8> m_damage_mask;
+		// path coverage of every tower, as offsets into m_coverage. Derived from the position and range, so it is not part of snapshots.
+		std::vector<blt::u32> m_coverage_first;
+		std::vector<blt::u32> m_coverage_count;
+		std::vector<path_interval_t> m_coverage;
+	};
+
+	// towers grouped by archetype. A tick is one vectorised cooldown pass per archetype, then target acquisition only for the towers
+	// which are ready to fire.
+	class tower_system_t
 	{
-		
+	public:
+		tower_system_t();
+
+		// id place() returns when nothing was placed
+		static constexpr blt::u32 NO_TOWER = ~0u;
+
+		// returns the id of the new tower, or NO_TOWER if type isn't a registered archetype
+		blt::u32 place(tower_id_t type, const blt::vec2& position);
+
+		// towers shoot at enemies as of the map's last step. Instant hits are appended for damage resolution, projectiles go into the pool.
+		void step(float dt, map_t& map, std::vector<hit_t>& hits, projectile_pool_t& projectiles, event_bus_t* events);
+
+		void write_instances(std::vector<sprite_instance_t>& instances) const;
+
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		[[nodiscard]] const std::vector<tower_archetype_t>& get_archetypes() const
+		{
+			return m_archetypes;
+		}
+
+		[[nodiscard]] const tower_archetype_t& get_archetype(const tower_id_t type) const
+		{
+			return m_archetypes[static_cast<blt::u32>(type)];
+		}
+
+		[[nodiscard]] blt::size_t size() const
+		{
+			return m_next_id;
+		}
+
+		// texture every tower sprite is drawn with, NO_TEXTURE by default. Presentation only, not part of snapshots or the state hash.
+		void set_texture(const blt::u32 texture)
+		{
+			m_texture = texture;
+		}
+
+	private:
+		void register_archetype(tower_id_t type, const tower_stats_t& stats);
+
+		std::vector<tower_archetype_t> m_archetypes;
+		// scratch list of ready towers, reused by every archetype
+		std::vector<blt::u32> m_ready;
+		blt::u32 m_next_id = 0;
+		blt::u32 m_texture = NO_TEXTURE;
 	};
 }
 
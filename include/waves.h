@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WAVES_H
+#define WAVES_H
+
+#include <enemies.h>
+#include <hash.h>
+#include <snapshot.h>
+#include <blt/std/types.h>
+#include <vector>
+
+namespace td
+{
+	struct wave_t
+	{
+		enemy_id_t enemy;
+		blt::u32 count;
+		// seconds between two enemies of the wave, 0 releases the whole wave at once
+		float spacing;
+		// game time in seconds of the first spawn
+		float start_time;
+	};
+
+	// an enemy which was due to spawn age seconds ago
+	struct wave_spawn_t
+	{
+		enemy_id_t enemy;
+		float age;
+	};
+
+	class wave_scheduler_t
+	{
+	public:
+		void add_wave(const wave_t& wave);
+
+		// appends every spawn due at or before time which hasn't been handed out yet. Spawns are computed, not stepped,
+		// so a large dt (or a whole wave with no spacing) produces every spawn in the window with its exact age.
+		void collect(double time, std::vector<wave_spawn_t>& spawns);
+
+		// true once every wave has been fully spawned
+		[[nodiscard]] bool is_finished() const
+		{
+			return m_next_wave == m_waves.size();
+		}
+
+		void clear();
+
+		void write_snapshot(snapshot_writer_t& writer) const;
+
+		bool read_snapshot(snapshot_reader_t& reader);
+
+		// adds the pending waves and spawn progress to a state hash
+		void add_to_hash(fnv1a_t& hash) const;
+
+	private:
+		// waves sorted by start time, with the number of enemies already spawned from each
+		std::vector<wave_t> m_waves;
+		std::vector<blt::u32> m_spawned;
+		// waves before this index have finished spawning
+		blt::size_t m_next_wave = 0;
+	};
+}
+
+#endif //WAVES_H
@@ -0,0 +1,133 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <allocation_tracker.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace td::allocation_tracker
+{
+	namespace
+	{
+		std::atomic<blt::u64> allocations{0};
+		std::atomic<blt::u64> deallocations{0};
+	}
+
+	blt::u64 get_allocations()
+	{
+		return allocations.load(std::memory_order_relaxed);
+	}
+
+	blt::u64 get_deallocations()
+	{
+		return deallocations.load(std::memory_order_relaxed);
+	}
+}
+
+#ifdef TD_TRACK_ALLOCATIONS
+
+// replacing the global operators catches every allocation, including the ones made inside std containers and blt.
+// the over-aligned variants are replaced too, the pools allocate their cache line aligned blocks through them.
+void* operator new(const std::size_t size)
+{
+	td::allocation_tracker::allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	td::allocation_tracker::deallocations.fetch_add(1, std::memory_order_relaxed);
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+	td::allocation_tracker::allocations.fetch_add(1, std::memory_order_relaxed);
+	const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+	// the MSVC runtime has no aligned_alloc, and its aligned blocks must go back through _aligned_free
+	void* ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+	// aligned_alloc wants a size which is a multiple of the alignment
+	void* ptr = std::aligned_alloc(align, (size == 0 ? align : size + align - 1) & ~(align - 1));
+#endif
+	if (ptr)
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	td::allocation_tracker::deallocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+void operator delete[](void* ptr, const std::align_val_t alignment) noexcept
+{
+	operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, const std::align_val_t alignment) noexcept
+{
+	operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, const std::align_val_t alignment) noexcept
+{
+	operator delete(ptr, alignment);
+}
+
+#endif
@@ -0,0 +1,324 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <game.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// runs many independent headless games over a sweep of balance parameters and writes aggregated results as CSV.
+// usage: tower-defense-balance <sweep spec> [output csv, default balance.csv] [worker threads]
+// see res/balance.txt for the spec format.
+
+namespace
+{
+	enum class parameter_t
+	{
+		HEALTH,
+		DAMAGE,
+		SPEED,
+		PATH_SPEED
+	};
+
+	struct sweep_t
+	{
+		parameter_t parameter;
+		td::enemy_id_t enemy;
+		float min;
+		float max;
+		blt::u32 steps;
+		std::string name;
+
+		[[nodiscard]] float get_value(const blt::u32 step) const
+		{
+			return steps <= 1 ? min : min + (max - min) * static_cast<float>(step) / static_cast<float>(steps - 1);
+		}
+	};
+
+	struct spec_t
+	{
+		std::vector<sweep_t> sweeps;
+		std::vector<td::wave_t> waves;
+		std::vector<td::tower_placement_t> towers;
+		blt::u32 runs = 100;
+		// seconds, each wave starts up to this much later
+		float start_jitter = 0;
+		// fraction, each wave's spacing is scaled by up to this much either way
+		float spacing_jitter = 0;
+		float max_time = 600;
+		blt::u64 seed = 0;
+	};
+
+	struct run_result_t
+	{
+		blt::u32 leaks = 0;
+		float damage_taken = 0;
+		// game time at which every wave had spawned and the map was empty, only meaningful if cleared
+		float clear_time = 0;
+		bool cleared = false;
+	};
+
+	struct leak_counter_t
+	{
+		blt::u32 leaks = 0;
+
+		void on_leaked(const td::enemy_leaked_event_t*, const blt::size_t count)
+		{
+			leaks += static_cast<blt::u32>(count);
+		}
+	};
+
+	bool parse_parameter(const std::string& name, parameter_t& parameter)
+	{
+		static const std::pair<const char*, parameter_t> names[] = {
+			{"health", parameter_t::HEALTH}, {"damage", parameter_t::DAMAGE}, {"speed", parameter_t::SPEED}, {"path_speed", parameter_t::PATH_SPEED}
+		};
+		for (const auto& [text, value] : names)
+		{
+			if (name == text)
+			{
+				parameter = value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool load_spec(const std::string& path, spec_t& spec)
+	{
+		std::ifstream file{path};
+		if (!file)
+		{
+			BLT_ERROR("Unable to open sweep spec '{}'", path);
+			return false;
+		}
+		std::string line;
+		blt::size_t line_number = 0;
+		while (std::getline(file, line))
+		{
+			++line_number;
+			line = line.substr(0, line.find('#'));
+			std::istringstream stream{line};
+			std::string directive;
+			if (!(stream >> directive))
+				continue;
+			bool ok;
+			if (directive == "sweep")
+			{
+				sweep_t sweep{};
+				std::string parameter, enemy;
+				ok = static_cast<bool>(stream >> parameter >> enemy >> sweep.min >> sweep.max >> sweep.steps) && parse_parameter(parameter, sweep.parameter)
+					&& (sweep.parameter == parameter_t::PATH_SPEED || td::parse_enemy_id(enemy, sweep.enemy));
+				sweep.name = sweep.parameter == parameter_t::PATH_SPEED ? parameter : parameter + "_" + enemy;
+				spec.sweeps.push_back(sweep);
+			} else if (directive == "wave")
+			{
+				td::wave_t wave{};
+				std::string enemy;
+				ok = static_cast<bool>(stream >> enemy >> wave.count >> wave.spacing >> wave.start_time) && td::parse_enemy_id(enemy, wave.enemy);
+				spec.waves.push_back(wave);
+			} else if (directive == "tower")
+			{
+				td::tower_placement_t tower{};
+				std::string type;
+				ok = static_cast<bool>(stream >> type >> tower.x >> tower.y) && td::parse_tower_id(type, tower.type);
+				spec.towers.push_back(tower);
+			} else if (directive == "runs")
+				ok = static_cast<bool>(stream >> spec.runs) && spec.runs > 0;
+			else if (directive == "start_jitter")
+				ok = static_cast<bool>(stream >> spec.start_jitter);
+			else if (directive == "spacing_jitter")
+				ok = static_cast<bool>(stream >> spec.spacing_jitter);
+			else if (directive == "max_time")
+				ok = static_cast<bool>(stream >> spec.max_time);
+			else if (directive == "seed")
+				ok = static_cast<bool>(stream >> spec.seed);
+			else
+				ok = false;
+			if (!ok)
+			{
+				BLT_ERROR("{}:{}: unable to parse '{}'", path, line_number, line);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// index of every sweep's step for a sweep point, the first sweep varying fastest
+	std::vector<blt::u32> get_steps(const spec_t& spec, blt::size_t point)
+	{
+		std::vector<blt::u32> steps;
+		for (const auto& sweep : spec.sweeps)
+		{
+			const auto count = std::max(sweep.steps, 1u);
+			steps.push_back(static_cast<blt::u32>(point % count));
+			point /= count;
+		}
+		return steps;
+	}
+
+	run_result_t run_game(const spec_t& spec, const std::vector<td::path_segment_t>& path, const blt::size_t point, const blt::u64 seed)
+	{
+		td::game_t game{path, td::game_t::DEFAULT_TICK_LENGTH, seed};
+		const auto steps = get_steps(spec, point);
+		for (blt::size_t i = 0; i < spec.sweeps.size(); ++i)
+		{
+			const auto& sweep = spec.sweeps[i];
+			const auto value = sweep.get_value(steps[i]);
+			if (sweep.parameter == parameter_t::PATH_SPEED)
+			{
+				game.get_map().set_speed_multiplier(value);
+				continue;
+			}
+			auto stats = game.get_database().get_stats(sweep.enemy);
+			switch (sweep.parameter)
+			{
+				case parameter_t::HEALTH:
+					stats.health = value;
+					break;
+				case parameter_t::DAMAGE:
+					stats.damage = value;
+					break;
+				case parameter_t::SPEED:
+					stats.speed = value;
+					break;
+				case parameter_t::PATH_SPEED:
+					break;
+			}
+			game.get_database().set_stats(sweep.enemy, stats);
+		}
+
+		// the jitter comes from the game's own rng so a run is reproducible from its seed alone
+		for (const auto& tower : spec.towers)
+		{
+			td::input_t input{0, td::input_type_t::PLACE_TOWER};
+			input.tower = tower;
+			game.queue_input(input);
+		}
+		auto& rng = game.get_rng();
+		for (auto wave : spec.waves)
+		{
+			wave.start_time += rng.next_float(0, spec.start_jitter);
+			wave.spacing *= 1 + rng.next_float(-spec.spacing_jitter, spec.spacing_jitter);
+			game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, wave});
+		}
+
+		leak_counter_t counter;
+		game.get_events().subscribe<td::enemy_leaked_event_t, leak_counter_t, &leak_counter_t::on_leaked>(counter);
+		run_result_t result;
+		while (game.get_time() < spec.max_time)
+		{
+			game.step(game.get_tick_length());
+			if (game.get_waves().is_finished() && game.get_map().get_enemies().empty())
+			{
+				result.cleared = true;
+				result.clear_time = static_cast<float>(game.get_time());
+				break;
+			}
+		}
+		result.leaks = counter.leaks;
+		result.damage_taken = game.get_damage_taken();
+		return result;
+	}
+
+	bool write_csv(const std::string& path, const spec_t& spec, const std::vector<run_result_t>& results)
+	{
+		std::ofstream file{path, std::ios::trunc};
+		file << "point";
+		for (const auto& sweep : spec.sweeps)
+			file << ',' << sweep.name;
+		file << ",runs,leaks_mean,leaks_min,leaks_max,damage_taken_mean,damage_taken_min,damage_taken_max,clear_rate,clear_time_mean\n";
+
+		const auto points = results.size() / spec.runs;
+		for (blt::size_t point = 0; point < points; ++point)
+		{
+			const auto steps = get_steps(spec, point);
+			file << point;
+			for (blt::size_t i = 0; i < spec.sweeps.size(); ++i)
+				file << ',' << spec.sweeps[i].get_value(steps[i]);
+
+			const auto begin = results.begin() + static_cast<std::ptrdiff_t>(point * spec.runs);
+			const auto end = begin + spec.runs;
+			double leaks = 0, damage = 0, clear_time = 0;
+			blt::u32 min_leaks = ~0u, max_leaks = 0, cleared = 0;
+			float min_damage = begin->damage_taken, max_damage = begin->damage_taken;
+			for (auto it = begin; it != end; ++it)
+			{
+				leaks += it->leaks;
+				damage += it->damage_taken;
+				min_leaks = std::min(min_leaks, it->leaks);
+				max_leaks = std::max(max_leaks, it->leaks);
+				min_damage = std::min(min_damage, it->damage_taken);
+				max_damage = std::max(max_damage, it->damage_taken);
+				if (it->cleared)
+				{
+					++cleared;
+					clear_time += it->clear_time;
+				}
+			}
+			const auto runs = static_cast<double>(spec.runs);
+			file << ',' << spec.runs << ',' << leaks / runs << ',' << min_leaks << ',' << max_leaks << ',' << damage / runs << ',' << min_damage << ','
+				<< max_damage << ',' << cleared / runs << ',';
+			if (cleared != 0)
+				file << clear_time / cleared;
+			file << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+}
+
+int main(const int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		BLT_ERROR("Usage: {} <sweep spec> [output csv] [worker threads]", argv[0]);
+		return 1;
+	}
+	spec_t spec;
+	if (!load_spec(argv[1], spec))
+		return 1;
+	const std::string output = argc > 2 ? argv[2] : "balance.csv";
+	const blt::size_t workers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : td::job_system_t::default_worker_count();
+
+	blt::size_t points = 1;
+	for (const auto& sweep : spec.sweeps)
+		points *= std::max(sweep.steps, 1u);
+	const auto total = points * spec.runs;
+	const auto path = td::make_default_path();
+
+	// every simulation owns its game, the only thing shared between workers is read only spec and path data
+	std::vector<run_result_t> results(total);
+	td::job_system_t jobs{workers};
+	const auto start = std::chrono::steady_clock::now();
+	jobs.parallel_for(total, 1, [&](const blt::size_t begin, const blt::size_t end) {
+		for (auto i = begin; i < end; ++i)
+			results[i] = run_game(spec, path, i / spec.runs, spec.seed + i);
+	});
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	BLT_INFO("Ran {} simulations ({} sweep points x {} runs) in {:.3f}s, {:.1f} sims/s", total, points, spec.runs, seconds,
+			static_cast<double>(total) / seconds);
+
+	if (!write_csv(output, spec, results))
+	{
+		BLT_ERROR("Unable to write '{}'", output);
+		return 1;
+	}
+	return 0;
+}
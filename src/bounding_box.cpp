@@ -16,6 +16,8 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <bounding_box.h>
+#include <algorithm>
+#include <limits>
 
 namespace td
 {
@@ -40,37 +42,241 @@ namespace td
 		return other.m_min <= m_max && other.m_max >= m_min;
 	}
 
-	blt::u8 b_box_hierarchy_t::search_children(bounding_box_t& other, blt::u8 startIndx) { // [NOT FINISHED]
-		if (startIndx == 0)
+	bounding_box_t bounding_box_t::merge(const bounding_box_t& other) const
+	{
+		return bounding_box_t{std::min(m_min.x(), other.m_min.x()), std::min(m_min.y(), other.m_min.y()), std::max(m_max.x(), other.m_max.x()),
+							std::max(m_max.y(), other.m_max.y())};
+	}
+
+	namespace
+	{
+		// leaves with at most this many boxes are never split
+		constexpr blt::u32 MIN_SPLIT_SIZE = 2;
+		// leaves larger than this are split even when SAH says it isn't worth it
+		constexpr blt::u32 MAX_LEAF_SIZE = 8;
+		constexpr blt::u32 BIN_COUNT = 8;
+		// bounds the traversal stack, nodes at this depth always become leaves
+		constexpr blt::u32 MAX_DEPTH = 48;
+
+		// 2d equivalent of the surface area used by SAH
+		float half_perimeter(const bounding_box_t& box)
+		{
+			const auto size = box.get_size();
+			return size.x() + size.y();
+		}
+
+		struct bin_t
+		{
+			float min_x = std::numeric_limits<float>::max();
+			float min_y = std::numeric_limits<float>::max();
+			float max_x = std::numeric_limits<float>::lowest();
+			float max_y = std::numeric_limits<float>::lowest();
+			blt::u32 count = 0;
+
+			void grow(const bounding_box_t& box)
+			{
+				min_x = std::min(min_x, box.get_min().x());
+				min_y = std::min(min_y, box.get_min().y());
+				max_x = std::max(max_x, box.get_max().x());
+				max_y = std::max(max_y, box.get_max().y());
+			}
+
+			void grow(const bin_t& bin)
+			{
+				min_x = std::min(min_x, bin.min_x);
+				min_y = std::min(min_y, bin.min_y);
+				max_x = std::max(max_x, bin.max_x);
+				max_y = std::max(max_y, bin.max_y);
+				count += bin.count;
+			}
+
+			[[nodiscard]] float half_perimeter() const
+			{
+				return count == 0 ? 0.0f : (max_x - min_x) + (max_y - min_y);
+			}
+		};
+	}
+
+	void b_box_hierarchy_t::build(std::vector<bounding_box_t> boxes)
+	{
+		m_boxes = std::move(boxes);
+		m_nodes.clear();
+		m_indices.resize(m_boxes.size());
+		if (m_boxes.empty())
+			return;
+
+		std::vector<blt::vec2> centers;
+		centers.reserve(m_boxes.size());
+		auto root_bounds = m_boxes.front();
+		for (blt::size_t i = 0; i < m_boxes.size(); ++i)
+		{
+			m_indices[i] = static_cast<blt::u32>(i);
+			centers.push_back(m_boxes[i].get_center());
+			root_bounds = root_bounds.merge(m_boxes[i]);
+		}
+
+		// a binary tree with n leaves never has more than 2n - 1 nodes, reserving keeps references stable while building
+		m_nodes.reserve(m_boxes.size() * 2);
+		m_nodes.push_back(b_box_node_t{root_bounds, 0, static_cast<blt::u32>(m_boxes.size())});
+		subdivide(0, centers, 0);
+	}
+
+	void b_box_hierarchy_t::subdivide(const blt::u32 node_index, const std::vector<blt::vec2>& centers, const blt::u32 depth)
+	{
+		const auto first = m_nodes[node_index].first;
+		const auto count = m_nodes[node_index].count;
+		if (count <= MIN_SPLIT_SIZE || depth >= MAX_DEPTH)
+			return;
+
+		// bin on the axis along which the box centers are spread the furthest
+		float center_min[2] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+		float center_max[2] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+		for (blt::u32 i = first; i < first + count; ++i)
 		{
-			for (blt::u8 i = startIndx; i < nodeTree.size(); i++)
+			const auto& center = centers[m_indices[i]];
+			for (blt::u32 axis = 0; axis < 2; ++axis)
 			{
-				if (nodeTree[i].get_bounds()->intersects(other)) return i;
+				const auto value = axis == 0 ? center.x() : center.y();
+				center_min[axis] = std::min(center_min[axis], value);
+				center_max[axis] = std::max(center_max[axis], value);
 			}
 		}
-		else
+		const blt::u32 axis = (center_max[0] - center_min[0]) >= (center_max[1] - center_min[1]) ? 0 : 1;
+		const auto extent = center_max[axis] - center_min[axis];
+		if (extent <= 0)
+			return;
+
+		const auto scale = static_cast<float>(BIN_COUNT) / extent;
+		const auto bin_of = [&](const blt::u32 index) {
+			const auto& center = centers[index];
+			const auto value = axis == 0 ? center.x() : center.y();
+			return std::min(static_cast<blt::u32>((value - center_min[axis]) * scale), BIN_COUNT - 1);
+		};
+
+		bin_t bins[BIN_COUNT];
+		for (blt::u32 i = first; i < first + count; ++i)
+		{
+			const auto index = m_indices[i];
+			auto& bin = bins[bin_of(index)];
+			bin.grow(m_boxes[index]);
+			++bin.count;
+		}
+
+		// sweep from both sides so the cost of every split plane is known in two passes
+		float left_cost[BIN_COUNT - 1];
+		bin_t left_accum;
+		for (blt::u32 i = 0; i < BIN_COUNT - 1; ++i)
+		{
+			left_accum.grow(bins[i]);
+			left_cost[i] = left_accum.half_perimeter() * static_cast<float>(left_accum.count);
+		}
+		bin_t right_accum;
+		auto best_cost = std::numeric_limits<float>::max();
+		blt::u32 best_split = 0;
+		for (blt::u32 i = BIN_COUNT - 1; i > 0; --i)
 		{
-			for (blt::u8 childIndex: nodeTree[startIndx].get_children()) {
-				if (nodeTree[childIndex].get_bounds()->intersects(other)) return childIndex;
+			right_accum.grow(bins[i]);
+			const auto cost = left_cost[i - 1] + right_accum.half_perimeter() * static_cast<float>(right_accum.count);
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_split = i;
 			}
 		}
-		return -1;
+
+		const auto leaf_cost = half_perimeter(m_nodes[node_index].bounds) * static_cast<float>(count);
+		if (best_cost >= leaf_cost && count <= MAX_LEAF_SIZE)
+			return;
+
+		const auto middle = std::partition(m_indices.begin() + first, m_indices.begin() + first + count, [&](const blt::u32 index) {
+			return bin_of(index) < best_split;
+		});
+		const auto left_count = static_cast<blt::u32>(middle - (m_indices.begin() + first));
+		if (left_count == 0 || left_count == count)
+			return;
+
+		const auto bounds_of = [&](const blt::u32 range_first, const blt::u32 range_count) {
+			auto bounds = m_boxes[m_indices[range_first]];
+			for (blt::u32 i = range_first + 1; i < range_first + range_count; ++i)
+				bounds = bounds.merge(m_boxes[m_indices[i]]);
+			return bounds;
+		};
+
+		const auto left_index = static_cast<blt::u32>(m_nodes.size());
+		m_nodes.push_back(b_box_node_t{bounds_of(first, left_count), first, left_count});
+		m_nodes.push_back(b_box_node_t{bounds_of(first + left_count, count - left_count), first + left_count, count - left_count});
+		m_nodes[node_index].first = left_index;
+		m_nodes[node_index].count = 0;
+
+		subdivide(left_index, centers, depth + 1);
+		subdivide(left_index + 1, centers, depth + 1);
 	}
 
-	void b_box_hierarchy_t::add_node(bounding_box_t* bBox) { // [NOT FINISHED]
-		if (nodeTree.size() == 0) return nodeTree.push_back(b_box_node_t(0, bBox, 0));
+	template <typename Overlaps>
+	void b_box_hierarchy_t::query(const Overlaps& overlaps, std::vector<blt::u32>& out) const
+	{
+		if (m_nodes.empty())
+			return;
+		blt::u32 stack[MAX_DEPTH + 2];
+		blt::u32 stack_size = 0;
+		stack[stack_size++] = 0;
+		while (stack_size > 0)
+		{
+			const auto& node = m_nodes[stack[--stack_size]];
+			if (!overlaps(node.bounds))
+				continue;
+			if (node.is_leaf())
+			{
+				for (blt::u32 i = node.first; i < node.first + node.count; ++i)
+				{
+					if (overlaps(m_boxes[m_indices[i]]))
+						out.push_back(m_indices[i]);
+				}
+			} else
+			{
+				stack[stack_size++] = node.first + 1;
+				stack[stack_size++] = node.first;
+			}
+		}
+	}
+
+	void b_box_hierarchy_t::contains(const blt::vec2& point, std::vector<blt::u32>& out) const
+	{
+		query([&point](const bounding_box_t& box) {
+			return box.contains(point);
+		}, out);
+	}
 
-		blt::u8 parentIndex, i = -1;
+	void b_box_hierarchy_t::intersections(const bounding_box_t& other, std::vector<blt::u32>& out) const
+	{
+		query([&other](const bounding_box_t& box) {
+			return box.intersects(other);
+		}, out);
+	}
 
-		do
+	void b_box_hierarchy_t::contains(const blt::vec2* points, const blt::size_t count, std::vector<blt::u32>& offsets,
+									std::vector<blt::u32>& results) const
+	{
+		offsets.resize(count + 1);
+		results.clear();
+		for (blt::size_t i = 0; i < count; ++i)
 		{
-			parentIndex = i;
-		} while (i = search_children(*bBox, parentIndex) != -1);
+			offsets[i] = static_cast<blt::u32>(results.size());
+			contains(points[i], results);
+		}
+		offsets[count] = static_cast<blt::u32>(results.size());
+	}
 
-		if (parentIndex != -1)
+	void b_box_hierarchy_t::intersections(const bounding_box_t* boxes, const blt::size_t count, std::vector<blt::u32>& offsets,
+										std::vector<blt::u32>& results) const
+	{
+		offsets.resize(count + 1);
+		results.clear();
+		for (blt::size_t i = 0; i < count; ++i)
 		{
-			nodeTree.push_back(b_box_node_t(parentIndex, bBox, nodeTree[parentIndex].get_depth() + 1));
-			nodeTree[parentIndex].add_child_index(nodeTree.size() - 1);
+			offsets[i] = static_cast<blt::u32>(results.size());
+			intersections(boxes[i], results);
 		}
+		offsets[count] = static_cast<blt::u32>(results.size());
 	}
 }
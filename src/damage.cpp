@@ -0,0 +1,72 @@
+/*
+ *  Batched damage resolution over enemy_store_t
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <damage.h>
+#include <simd.h>
+#include <algorithm>
+
+namespace td
+{
+	void damage_resolver_t::resolve(enemy_store_t& enemies, const std::vector<hit_t>& hits, std::vector<blt::u32>& kills)
+	{
+		if (hits.empty())
+			return;
+		const auto count = static_cast<blt::u32>(enemies.size());
+		const auto& resistances = enemies.get_resistances();
+
+		// pass one: fold every hit into a per enemy total. Several hits can land on one enemy so this part stays scalar
+		m_pending.assign(count, 0.0f);
+		for (const auto& hit : hits)
+		{
+			const auto index = enemies.get_index(hit.enemy);
+			if (index == enemy_store_t::INVALID_INDEX)
+				continue;
+			m_pending[index] += hit.amount * static_cast<float>(damage_applies(hit.damage_mask, resistances[index]));
+		}
+
+		// pass two: subtract the totals from health and collect everything which died
+		float* health = enemies.get_health_left().data();
+		const float* pending = m_pending.data();
+		blt::u32 i = 0;
+#if defined(TD_SIMD_AVX)
+		const auto zero_v = _mm256_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			const auto h = _mm256_sub_ps(_mm256_loadu_ps(health + i), _mm256_loadu_ps(pending + i));
+			_mm256_storeu_ps(health + i, h);
+			simd::append_mask_indices(_mm256_movemask_ps(_mm256_cmp_ps(h, zero_v, _CMP_LE_OQ)), i, kills);
+		}
+#elif defined(TD_SIMD_SSE)
+		const auto zero_v = _mm_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			const auto h_lo = _mm_sub_ps(_mm_loadu_ps(health + i), _mm_loadu_ps(pending + i));
+			const auto h_hi = _mm_sub_ps(_mm_loadu_ps(health + i + 4), _mm_loadu_ps(pending + i + 4));
+			_mm_storeu_ps(health + i, h_lo);
+			_mm_storeu_ps(health + i + 4, h_hi);
+			const int mask = _mm_movemask_ps(_mm_cmple_ps(h_lo, zero_v)) | (_mm_movemask_ps(_mm_cmple_ps(h_hi, zero_v)) << 4);
+			simd::append_mask_indices(mask, i, kills);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			health[i] -= pending[i];
+			if (health[i] <= 0)
+				kills.push_back(i);
+		}
+	}
+}
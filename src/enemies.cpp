@@ -16,6 +16,14 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <enemies.h>
+#include <hash.h>
+#include <profiler.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 
 td::enemy_t::enemy_t(std::string texture_name, std::vector<enemy_id_t> children, const damage_type_t damage_resistence, const float health,
 					const float damage, const float speed): m_texture_name(std::move(texture_name)), m_children(std::move(children)),
@@ -27,7 +35,308 @@ td::enemy_t::enemy_t(std::string texture_name, std::vector<enemy_id_t> children)
 																				m_children(std::move(children))
 {}
 
+namespace
+{
+	// names used for enemy ids in text sources, indexed by enemy_id_t
+	constexpr std::string_view enemy_names[] = {"TEST", "TEST_SPLITTER"};
+	static_assert(std::size(enemy_names) == td::ENEMY_ID_COUNT, "every enemy_id_t needs a name");
+
+	constexpr std::pair<std::string_view, td::damage_type_t> damage_type_names[] = {
+		{"BASE", td::damage_type_t::BASE}, {"WAG_TAIL", td::damage_type_t::WAG_TAIL}, {"KISSES", td::damage_type_t::KISSES},
+		{"HUGS", td::damage_type_t::HUGS}, {"CUDDLES", td::damage_type_t::CUDDLES}, {"LUST", td::damage_type_t::LUST},
+		{"LOVE", td::damage_type_t::LOVE}
+	};
+
+	// a '|' separated list of damage type names
+	bool parse_damage_types(const std::string_view names, blt::u8& mask)
+	{
+		mask = 0;
+		blt::size_t begin = 0;
+		while (begin <= names.size())
+		{
+			auto end = names.find('|', begin);
+			if (end == std::string_view::npos)
+				end = names.size();
+			const auto name = names.substr(begin, end - begin);
+			const auto it = std::find_if(std::begin(damage_type_names), std::end(damage_type_names), [name](const auto& pair) {
+				return pair.first == name;
+			});
+			if (it == std::end(damage_type_names))
+				return false;
+			mask |= static_cast<blt::u8>(it->second);
+			begin = end + 1;
+		}
+		return true;
+	}
+
+	template <typename T>
+	blt::size_t words_for(const blt::size_t count)
+	{
+		return (count * sizeof(T) + sizeof(blt::u32) - 1) / sizeof(blt::u32);
+	}
+}
+
+bool td::parse_enemy_id(const std::string_view name, enemy_id_t& id)
+{
+	const auto it = std::find(std::begin(enemy_names), std::end(enemy_names), name);
+	if (it == std::end(enemy_names))
+		return false;
+	id = static_cast<enemy_id_t>(it - std::begin(enemy_names));
+	return true;
+}
+
+std::string_view td::get_enemy_name(const enemy_id_t id)
+{
+	const auto index = static_cast<blt::u32>(id);
+	return index < std::size(enemy_names) ? enemy_names[index] : std::string_view{};
+}
+
 void td::enemy_database_t::register_entities()
 {
 	add_enemy(enemy_id_t::TEST, enemy_t{"test", {}}.set_speed(10));
+	add_enemy(enemy_id_t::TEST_SPLITTER, enemy_t{"test", {enemy_id_t::TEST, enemy_id_t::TEST}}.set_health(2).set_speed(8));
+}
+
+void td::enemy_database_t::add_enemy(enemy_id_t enemy_id, const enemy_t& enemy)
+{
+	const auto index = static_cast<blt::u32>(enemy_id);
+	if (enemies_registry.size() <= index)
+		enemies_registry.resize(index + 1, enemy_t{"no_enemy_texture", {}});
+	enemies_registry[index] = enemy;
+	rebuild_tables();
+}
+
+void td::enemy_database_t::rebuild_tables()
+{
+	// ids nobody defined yet get a placeholder, attach() only accepts tables covering every enemy_id_t
+	if (enemies_registry.size() < ENEMY_ID_COUNT)
+		enemies_registry.resize(ENEMY_ID_COUNT, enemy_t{"no_enemy_texture", {}});
+	std::vector<std::string> texture_names;
+	std::vector<enemy_stats_t> stats;
+	std::vector<enemy_id_t> children;
+	for (const auto& enemy : enemies_registry)
+	{
+		const auto name = std::find(texture_names.begin(), texture_names.end(), enemy.get_texture_name());
+		const auto texture = static_cast<blt::u32>(name - texture_names.begin());
+		if (name == texture_names.end())
+			texture_names.push_back(enemy.get_texture_name());
+		enemy_stats_t record;
+		record.health = enemy.get_health();
+		record.damage = enemy.get_damage();
+		record.speed = enemy.get_speed();
+		record.texture = texture;
+		record.first_child = static_cast<blt::u32>(children.size());
+		record.child_count = static_cast<blt::u32>(enemy.get_children().size());
+		record.resistance = static_cast<blt::u8>(enemy.get_damage_resistence());
+		stats.push_back(record);
+		children.insert(children.end(), enemy.get_children().begin(), enemy.get_children().end());
+	}
+
+	std::vector<blt::u32> texture_offsets{0};
+	std::string texture_chars;
+	for (const auto& name : texture_names)
+	{
+		texture_chars += name;
+		texture_offsets.push_back(static_cast<blt::u32>(texture_chars.size()));
+	}
+
+	enemy_database_header_t header;
+	header.enemy_count = static_cast<blt::u32>(stats.size());
+	header.child_count = static_cast<blt::u32>(children.size());
+	header.texture_count = static_cast<blt::u32>(texture_names.size());
+	header.texture_bytes = static_cast<blt::u32>(texture_chars.size());
+
+	m_packed.assign(words_for<enemy_database_header_t>(1) + words_for<enemy_stats_t>(stats.size()) + words_for<enemy_id_t>(children.size()) +
+					words_for<blt::u32>(texture_offsets.size()) + words_for<char>(texture_chars.size()), 0);
+	auto* out = reinterpret_cast<char*>(m_packed.data());
+	const auto write = [&out](const void* data, const blt::size_t bytes) {
+		if (bytes != 0)
+			std::memcpy(out, data, bytes);
+		out += (bytes + sizeof(blt::u32) - 1) / sizeof(blt::u32) * sizeof(blt::u32);
+	};
+	write(&header, sizeof(header));
+	write(stats.data(), stats.size() * sizeof(enemy_stats_t));
+	write(children.data(), children.size() * sizeof(enemy_id_t));
+	write(texture_offsets.data(), texture_offsets.size() * sizeof(blt::u32));
+	write(texture_chars.data(), texture_chars.size());
+
+	m_file.close();
+	attach(m_packed.data(), m_packed.size() * sizeof(blt::u32));
+}
+
+void td::enemy_database_t::set_stats(const enemy_id_t id, const enemy_stats_t& stats)
+{
+	// a mapped database is read only, tuning works on a private copy of it
+	if (m_packed.empty())
+	{
+		m_packed.resize((m_size + sizeof(blt::u32) - 1) / sizeof(blt::u32));
+		std::memcpy(m_packed.data(), m_header, m_size);
+		m_file.close();
+		attach(m_packed.data(), m_size);
+	}
+	const auto index = static_cast<blt::u32>(id);
+	auto& record = const_cast<enemy_stats_t&>(m_stats[index]);
+	record.health = stats.health;
+	record.damage = stats.damage;
+	record.speed = stats.speed;
+	record.resistance = stats.resistance;
+	// keep the definitions in step so a later add_enemy() doesn't undo the override
+	if (index < enemies_registry.size())
+	{
+		enemies_registry[index].set_health(stats.health).set_damage(stats.damage).set_speed(stats.speed).set_damage_resistence(
+			static_cast<damage_type_t>(stats.resistance));
+	}
+}
+
+bool td::enemy_database_t::attach(const void* data, const blt::size_t size)
+{
+	const auto* bytes = static_cast<const char*>(data);
+	if (size < sizeof(enemy_database_header_t))
+		return false;
+	const auto* header = reinterpret_cast<const enemy_database_header_t*>(bytes);
+	if (header->magic != enemy_database_header_t::MAGIC || header->version != enemy_database_header_t::VERSION)
+		return false;
+	// get_stats() indexes by enemy_id_t without checking, so every id must have an entry
+	if (header->enemy_count < ENEMY_ID_COUNT)
+		return false;
+
+	blt::size_t offset = words_for<enemy_database_header_t>(1) * sizeof(blt::u32);
+	const auto stats_offset = offset;
+	offset += words_for<enemy_stats_t>(header->enemy_count) * sizeof(blt::u32);
+	const auto children_offset = offset;
+	offset += words_for<enemy_id_t>(header->child_count) * sizeof(blt::u32);
+	const auto texture_offsets_offset = offset;
+	offset += words_for<blt::u32>(header->texture_count + 1ull) * sizeof(blt::u32);
+	const auto texture_names_offset = offset;
+	offset += header->texture_bytes;
+	if (offset > size)
+		return false;
+
+	// the tables are trusted from here on, so check every index they hold once now instead of on every lookup
+	const auto* stats = reinterpret_cast<const enemy_stats_t*>(bytes + stats_offset);
+	const auto* children = reinterpret_cast<const enemy_id_t*>(bytes + children_offset);
+	const auto* texture_offsets = reinterpret_cast<const blt::u32*>(bytes + texture_offsets_offset);
+	for (blt::u32 i = 0; i < header->enemy_count; ++i)
+	{
+		if (stats[i].texture >= header->texture_count || stats[i].first_child > header->child_count ||
+			stats[i].child_count > header->child_count - stats[i].first_child)
+			return false;
+	}
+	for (blt::u32 i = 0; i < header->child_count; ++i)
+	{
+		if (static_cast<blt::u32>(children[i]) >= header->enemy_count)
+			return false;
+	}
+	for (blt::u32 i = 0; i < header->texture_count; ++i)
+	{
+		if (texture_offsets[i] > texture_offsets[i + 1] || texture_offsets[i + 1] > header->texture_bytes)
+			return false;
+	}
+
+	m_header = header;
+	m_size = size;
+	m_stats = stats;
+	m_children = children;
+	m_texture_offsets = texture_offsets;
+	m_texture_names = bytes + texture_names_offset;
+	return true;
+}
+
+bool td::enemy_database_t::load_text(const std::string& path)
+{
+	TD_PROFILE_ZONE("enemy database load_text");
+	std::ifstream file{path};
+	if (!file)
+	{
+		BLT_WARN("Unable to open enemy definitions '{}'", path);
+		return false;
+	}
+	std::vector<enemy_t> registry;
+	std::vector<bool> defined(ENEMY_ID_COUNT, false);
+	std::string line;
+	blt::size_t line_number = 0;
+	while (std::getline(file, line))
+	{
+		++line_number;
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream{line};
+		std::string name, texture, resistances;
+		float health, damage, speed;
+		if (!(stream >> name))
+			continue;
+		enemy_id_t id;
+		blt::u8 resistance;
+		if (!parse_enemy_id(name, id))
+		{
+			BLT_WARN("{}:{}: unknown enemy '{}'", path, line_number, name);
+			return false;
+		}
+		if (!(stream >> texture >> health >> damage >> speed >> resistances) || !parse_damage_types(resistances, resistance))
+		{
+			BLT_WARN("{}:{}: expected 'name texture health damage speed resistances [children...]'", path, line_number);
+			return false;
+		}
+		std::vector<enemy_id_t> children;
+		std::string child_name;
+		while (stream >> child_name)
+		{
+			if (!parse_enemy_id(child_name, children.emplace_back()))
+			{
+				BLT_WARN("{}:{}: unknown child enemy '{}'", path, line_number, child_name);
+				return false;
+			}
+		}
+		const auto index = static_cast<blt::u32>(id);
+		if (registry.size() <= index)
+			registry.resize(index + 1, enemy_t{"no_enemy_texture", {}});
+		registry[index] = enemy_t{texture, std::move(children), static_cast<damage_type_t>(resistance), health, damage, speed};
+		defined[index] = true;
+	}
+	for (blt::u32 i = 0; i < ENEMY_ID_COUNT; ++i)
+	{
+		if (!defined[i])
+		{
+			BLT_WARN("{}: enemy '{}' is not defined", path, get_enemy_name(static_cast<enemy_id_t>(i)));
+			return false;
+		}
+	}
+	enemies_registry = std::move(registry);
+	rebuild_tables();
+	return true;
+}
+
+bool td::enemy_database_t::load_binary(const std::string& path)
+{
+	TD_PROFILE_ZONE("enemy database load_binary");
+	mapped_file_t file;
+	if (!file.open(path))
+		return false;
+	if (!attach(file.data(), file.size()))
+	{
+		BLT_WARN("'{}' is not an enemy database", path);
+		// attach() leaves the tables alone when it fails, they still point at the old definitions
+		return false;
+	}
+	m_file = std::move(file);
+	m_packed.clear();
+	enemies_registry.clear();
+	return true;
+}
+
+bool td::enemy_database_t::write_binary(const std::string& path) const
+{
+	std::ofstream file{path, std::ios::binary | std::ios::trunc};
+	if (!file.write(reinterpret_cast<const char*>(m_header), static_cast<std::streamsize>(m_size)))
+	{
+		BLT_WARN("Unable to write enemy database '{}'", path);
+		return false;
+	}
+	return true;
+}
+
+blt::u64 td::enemy_database_t::compute_hash() const
+{
+	fnv1a_t hash;
+	hash.add_bytes(m_header, m_size);
+	return hash.value;
 }
@@ -0,0 +1,35 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <enemies.h>
+#include <blt/logging/logging.h>
+
+// compiles a text enemy definition file into the binary database enemy_database_t::load_binary() maps at startup
+// usage: tower-defense-enemy-compiler <input.txt> <output.bin>
+int main(const int argc, const char** argv)
+{
+	if (argc != 3)
+	{
+		BLT_ERROR("Usage: {} <input.txt> <output.bin>", argc > 0 ? argv[0] : "tower-defense-enemy-compiler");
+		return 1;
+	}
+	td::enemy_database_t database;
+	if (!database.load_text(argv[1]) || !database.write_binary(argv[2]))
+		return 1;
+	BLT_INFO("Compiled {} enemies using {} textures into '{}'", database.get_enemy_count(), database.get_texture_count(), argv[2]);
+	return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <enemy_store.h>
+#include <simd.h>
+
+namespace td
+{
+	enemy_handle_t enemy_store_t::add(const enemy_instance_t& enemy, const float speed, const blt::u8 resistance)
+	{
+		const auto dense_index = static_cast<blt::u32>(m_ids.size());
+		blt::u32 sparse_index;
+		if (!m_free_handles.empty())
+		{
+			sparse_index = m_free_handles.back();
+			m_free_handles.pop_back();
+			m_sparse[sparse_index].dense_index = dense_index;
+		} else
+		{
+			sparse_index = static_cast<blt::u32>(m_sparse.size());
+			m_sparse.push_back(sparse_entry_t{dense_index, 0});
+		}
+
+		m_ids.push_back(enemy.id);
+		m_health_left.push_back(enemy.health_left);
+		m_distance_along_path.push_back(enemy.distance_along_path);
+		m_speed.push_back(speed);
+		m_resistances.push_back(resistance);
+		m_handles.push_back(sparse_index);
+
+		return enemy_handle_t{sparse_index, m_sparse[sparse_index].generation};
+	}
+
+	void enemy_store_t::add_batch(const enemy_batch_t& batch)
+	{
+		const auto first = static_cast<blt::u32>(m_ids.size());
+		const auto count = static_cast<blt::u32>(batch.size());
+		m_ids.insert(m_ids.end(), batch.ids.begin(), batch.ids.end());
+		m_health_left.insert(m_health_left.end(), batch.health_left.begin(), batch.health_left.end());
+		m_distance_along_path.insert(m_distance_along_path.end(), batch.distance_along_path.begin(), batch.distance_along_path.end());
+		m_speed.insert(m_speed.end(), batch.speed.begin(), batch.speed.end());
+		m_resistances.insert(m_resistances.end(), batch.resistances.begin(), batch.resistances.end());
+
+		m_handles.resize(first + count);
+		for (blt::u32 i = 0; i < count; ++i)
+		{
+			blt::u32 sparse_index;
+			if (!m_free_handles.empty())
+			{
+				sparse_index = m_free_handles.back();
+				m_free_handles.pop_back();
+				m_sparse[sparse_index].dense_index = first + i;
+			} else
+			{
+				sparse_index = static_cast<blt::u32>(m_sparse.size());
+				m_sparse.push_back(sparse_entry_t{first + i, 0});
+			}
+			m_handles[first + i] = sparse_index;
+		}
+	}
+
+	void enemy_store_t::remove(const blt::size_t index)
+	{
+		const auto last = m_ids.size() - 1;
+		const auto removed_handle = m_handles[index];
+		if (index != last)
+		{
+			m_ids[index] = m_ids[last];
+			m_health_left[index] = m_health_left[last];
+			m_distance_along_path[index] = m_distance_along_path[last];
+			m_speed[index] = m_speed[last];
+			m_resistances[index] = m_resistances[last];
+			m_handles[index] = m_handles[last];
+			m_sparse[m_handles[index]].dense_index = static_cast<blt::u32>(index);
+		}
+		m_ids.pop_back();
+		m_health_left.pop_back();
+		m_distance_along_path.pop_back();
+		m_speed.pop_back();
+		m_resistances.pop_back();
+		m_handles.pop_back();
+
+		// bumping the generation invalidates every handle still pointing at the removed enemy
+		auto& entry = m_sparse[removed_handle];
+		entry.dense_index = INVALID_INDEX;
+		++entry.generation;
+		m_free_handles.push_back(removed_handle);
+	}
+
+	void enemy_store_t::reserve(const blt::size_t count)
+	{
+		m_ids.reserve(count);
+		m_health_left.reserve(count);
+		m_distance_along_path.reserve(count);
+		m_speed.reserve(count);
+		m_resistances.reserve(count);
+		m_handles.reserve(count);
+		m_sparse.reserve(count);
+	}
+
+	void enemy_store_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		writer.write(m_ids);
+		writer.write(m_health_left);
+		writer.write(m_distance_along_path);
+		writer.write(m_speed);
+		writer.write(m_resistances);
+		writer.write(m_handles);
+		writer.write(m_sparse);
+		writer.write(m_free_handles);
+	}
+
+	bool enemy_store_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		reader.read(m_ids);
+		reader.read(m_health_left);
+		reader.read(m_distance_along_path);
+		reader.read(m_speed);
+		reader.read(m_resistances);
+		reader.read(m_handles);
+		reader.read(m_sparse);
+		reader.read(m_free_handles);
+		const auto count = m_ids.size();
+		return reader.good() && m_health_left.size() == count && m_distance_along_path.size() == count && m_speed.size() == count &&
+			m_resistances.size() == count && m_handles.size() == count;
+	}
+
+	void enemy_store_t::clear()
+	{
+		while (!empty())
+			remove(m_ids.size() - 1);
+	}
+
+	void enemy_store_t::advance(const float delta, const float limit, const blt::size_t begin, const blt::size_t end,
+								std::vector<blt::u32>& crossed)
+	{
+		const auto count = static_cast<blt::u32>(end);
+		float* distance = m_distance_along_path.data();
+		const float* speed = m_speed.data();
+
+		auto i = static_cast<blt::u32>(begin);
+#if defined(TD_SIMD_AVX)
+		const auto delta_v = _mm256_set1_ps(delta);
+		const auto limit_v = _mm256_set1_ps(limit);
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			auto p = _mm256_loadu_ps(distance + i);
+			p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_loadu_ps(speed + i), delta_v));
+			_mm256_storeu_ps(distance + i, p);
+			const int mask = _mm256_movemask_ps(_mm256_cmp_ps(p, limit_v, _CMP_GE_OQ));
+			simd::append_mask_indices(mask, i, crossed);
+		}
+#elif defined(TD_SIMD_SSE)
+		const auto delta_v = _mm_set1_ps(delta);
+		const auto limit_v = _mm_set1_ps(limit);
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			auto p_lo = _mm_loadu_ps(distance + i);
+			auto p_hi = _mm_loadu_ps(distance + i + 4);
+			p_lo = _mm_add_ps(p_lo, _mm_mul_ps(_mm_loadu_ps(speed + i), delta_v));
+			p_hi = _mm_add_ps(p_hi, _mm_mul_ps(_mm_loadu_ps(speed + i + 4), delta_v));
+			_mm_storeu_ps(distance + i, p_lo);
+			_mm_storeu_ps(distance + i + 4, p_hi);
+			const int mask = _mm_movemask_ps(_mm_cmpge_ps(p_lo, limit_v)) | (_mm_movemask_ps(_mm_cmpge_ps(p_hi, limit_v)) << 4);
+			simd::append_mask_indices(mask, i, crossed);
+		}
+#endif
+		// scalar tail, or the whole array when no SIMD is available
+		for (; i < count; ++i)
+		{
+			distance[i] += speed[i] * delta;
+			if (distance[i] >= limit)
+				crossed.push_back(i);
+		}
+	}
+}
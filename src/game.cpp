@@ -16,6 +16,185 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <game.h>
+#include <hash.h>
+#include <profiler.h>
+#include <cstddef>
+#include <cstring>
 
 namespace td
-{}
+{
+	namespace
+	{
+		struct snapshot_header_t
+		{
+			static constexpr blt::u32 MAGIC = 0x50534454; // "TDSP"
+			static constexpr blt::u32 VERSION = 4;
+
+			blt::u32 magic;
+			blt::u32 version;
+			blt::u64 size;
+			blt::u64 database_hash;
+			float tick_length;
+			float path_length;
+		};
+	}
+
+	game_t::game_t(const std::vector<path_segment_t>& path_segments, const float tick_length, const blt::u64 seed):
+		m_map{path_segments, m_database}, m_tick_length{tick_length}, m_rng{seed}, m_seed{seed}
+	{
+		m_map.set_event_bus(&m_events);
+	}
+
+	void game_t::start_recording(const blt::u32 hash_interval)
+	{
+		m_replay = replay_t{};
+		m_replay.seed = m_seed;
+		m_replay.database_hash = m_database.compute_hash();
+		m_replay.speed_multiplier = m_map.get_speed_multiplier();
+		m_replay.tick_length = m_tick_length;
+		m_replay.hash_interval = hash_interval;
+		m_recording = true;
+	}
+
+	void game_t::save_snapshot(std::vector<blt::u8>& buffer) const
+	{
+		buffer.clear();
+		snapshot_writer_t writer{buffer};
+		// size is patched in once everything has been written
+		writer.write(snapshot_header_t{snapshot_header_t::MAGIC, snapshot_header_t::VERSION, 0, m_database.compute_hash(), m_tick_length,
+										m_map.get_total_length()});
+		writer.write(m_tick);
+		writer.write(m_time);
+		writer.write(m_accumulator);
+		writer.write(m_damage_taken);
+		writer.write(m_rng.get_state());
+		writer.write(m_hits);
+		writer.write(m_inputs);
+		m_waves.write_snapshot(writer);
+		m_map.write_snapshot(writer);
+		m_towers.write_snapshot(writer);
+		m_projectiles.write_snapshot(writer);
+		const auto size = static_cast<blt::u64>(buffer.size());
+		std::memcpy(buffer.data() + offsetof(snapshot_header_t, size), &size, sizeof(size));
+	}
+
+	bool game_t::restore_snapshot(const std::vector<blt::u8>& buffer)
+	{
+		snapshot_reader_t reader{buffer.data(), buffer.size()};
+		snapshot_header_t header{};
+		if (!reader.read(header) || header.magic != snapshot_header_t::MAGIC || header.version != snapshot_header_t::VERSION ||
+			header.size != buffer.size() || header.tick_length != m_tick_length || header.path_length != m_map.get_total_length() ||
+			header.database_hash != m_database.compute_hash())
+			return false;
+		blt::u64 rng_state = 0;
+		reader.read(m_tick);
+		reader.read(m_time);
+		reader.read(m_accumulator);
+		reader.read(m_damage_taken);
+		reader.read(rng_state);
+		reader.read(m_hits);
+		reader.read(m_inputs);
+		m_rng.set_state(rng_state);
+		m_recording = false;
+		return m_waves.read_snapshot(reader) && m_map.read_snapshot(reader) && m_towers.read_snapshot(reader) &&
+			m_projectiles.read_snapshot(reader) && reader.remaining() == 0;
+	}
+
+	blt::u64 game_t::compute_state_hash() const
+	{
+		fnv1a_t hash;
+		const auto& enemies = m_map.get_enemies();
+		hash.add(m_tick);
+		hash.add(m_time);
+		hash.add(m_damage_taken);
+		hash.add(m_rng.get_state());
+		hash.add(m_map.get_speed_multiplier());
+		hash.add(enemies.get_ids());
+		hash.add(enemies.get_health_left());
+		hash.add(enemies.get_distance_along_path());
+		hash.add(enemies.get_speed());
+		hash.add(enemies.get_resistances());
+		for (const auto& archetype : m_towers.get_archetypes())
+		{
+			hash.add(archetype.get_x());
+			hash.add(archetype.get_y());
+			hash.add(archetype.get_cooldowns());
+			hash.add(archetype.get_damage());
+		}
+		m_waves.add_to_hash(hash);
+		m_projectiles.add_to_hash(hash);
+		return hash.value;
+	}
+
+	void game_t::step(const float dt)
+	{
+		TD_PROFILE_ZONE("game step");
+		for (const auto& input : m_inputs)
+		{
+			switch (input.type)
+			{
+				case input_type_t::START_WAVE:
+					m_waves.add_wave(input.wave);
+					break;
+				case input_type_t::PLACE_TOWER:
+					m_towers.place(input.tower.type, blt::vec2{input.tower.x, input.tower.y});
+					break;
+			}
+		}
+		if (m_recording)
+			m_replay.inputs.insert(m_replay.inputs.end(), m_inputs.begin(), m_inputs.end());
+		m_inputs.clear();
+
+		// spawns due by the start of this tick begin as far along the path as they would have travelled since they were due
+		m_wave_spawns.clear();
+		m_waves.collect(m_time, m_wave_spawns);
+		m_map.spawn_batch(m_wave_spawns);
+		m_damage_taken += m_map.step(dt);
+		// projectiles already in flight move first, ones launched this tick start moving next tick
+		m_projectiles.step(dt, m_map, m_hits, &m_events);
+		m_towers.step(dt, m_map, m_hits, m_projectiles, &m_events);
+		m_map.apply_damage(m_hits);
+		m_hits.clear();
+		{
+			TD_PROFILE_ZONE("event dispatch");
+			m_events.dispatch();
+		}
+		m_time += dt;
+		++m_tick;
+		if (m_recording && m_replay.hash_interval != 0 && m_tick % m_replay.hash_interval == 0)
+			m_replay.checkpoints.push_back(replay_checkpoint_t{m_tick, compute_state_hash()});
+	}
+
+	blt::u32 game_t::update(const float frame_delta)
+	{
+		// stop a long stall (window drag, breakpoint) from queueing up seconds of ticks
+		constexpr blt::u32 max_ticks_per_update = 8;
+		m_accumulator += frame_delta;
+		blt::u32 ticks = 0;
+		while (m_accumulator >= m_tick_length && ticks < max_ticks_per_update)
+		{
+			step(m_tick_length);
+			m_accumulator -= m_tick_length;
+			++ticks;
+		}
+		if (ticks == max_ticks_per_update)
+			m_accumulator = 0;
+		publish_instances();
+		return ticks;
+	}
+
+	void game_t::publish_instances()
+	{
+		TD_PROFILE_ZONE("publish instances");
+		auto& instances = m_enemy_instances.begin_write();
+		m_map.write_instances(instances);
+		m_towers.write_instances(instances);
+		m_projectiles.write_instances(instances);
+		m_enemy_instances.publish();
+	}
+
+	void game_t::render(blt::gfx::batch_renderer_2d& renderer)
+	{
+		m_map.draw(renderer);
+	}
+}
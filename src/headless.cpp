@@ -0,0 +1,116 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <game.h>
+#include <blt/logging/logging.h>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+
+// ticks between state hashes in recorded replays
+constexpr blt::u32 REPLAY_HASH_INTERVAL = 60;
+
+// re-simulates a recorded game and checks it against the recorded state hashes
+int verify_replay(const std::string& path, const blt::size_t workers)
+{
+	td::replay_t replay;
+	if (!replay.read(path))
+	{
+		BLT_ERROR("Unable to read replay '{}'", path);
+		return 1;
+	}
+	td::job_system_t jobs{workers};
+	const auto start = std::chrono::steady_clock::now();
+	const auto result = td::play_replay(replay, td::make_default_path(), &jobs);
+	const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!result.database_matched)
+	{
+		BLT_ERROR("Replay was recorded with different enemy definitions");
+		return 1;
+	}
+	if (!result.matched())
+	{
+		BLT_ERROR("Replay diverged at tick {}", result.mismatch_tick);
+		return 1;
+	}
+	BLT_INFO("Replay matched {} checkpoints over {} ticks in {:.3f}s", replay.checkpoints.size(), result.ticks, seconds);
+	return 0;
+}
+
+// runs the simulation without a window or GL context, as fast as the cpu allows.
+// usage: tower-defense-headless [ticks] [ticks between spawns, 0 to disable] [worker threads, 0 for a serial update] [replay output path]
+//        tower-defense-headless --replay <replay path> [worker threads]
+int main(const int argc, const char** argv)
+{
+	if (argc > 2 && std::string_view{argv[1]} == "--replay")
+		return verify_replay(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : td::job_system_t::default_worker_count());
+
+	const blt::u64 ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	const blt::u64 spawn_interval = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+	const blt::size_t workers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : td::job_system_t::default_worker_count();
+	const char* replay_path = argc > 4 ? argv[4] : nullptr;
+
+	td::job_system_t jobs{workers};
+	td::game_t game{td::make_default_path()};
+	game.get_map().set_job_system(&jobs);
+	if (replay_path)
+		game.start_recording(REPLAY_HASH_INTERVAL);
+	if (spawn_interval != 0)
+	{
+		const auto spawn_count = static_cast<blt::u32>((ticks + spawn_interval - 1) / spawn_interval);
+		game.queue_input(td::input_t{0, td::input_type_t::START_WAVE,
+									td::wave_t{td::enemy_id_t::TEST, spawn_count, static_cast<float>(spawn_interval) * game.get_tick_length(), 0}});
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for (blt::u64 tick = 0; tick < ticks; ++tick)
+	{
+		game.step(game.get_tick_length());
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto seconds = std::chrono::duration<double>(end - start).count();
+	const auto game_seconds = static_cast<double>(ticks) * game.get_tick_length();
+	BLT_INFO("Simulated {} ticks ({:.1f}s of game time) in {:.3f}s, {:.0f} ticks/s", ticks, game_seconds, seconds,
+			static_cast<double>(ticks) / seconds);
+	BLT_INFO("Enemies alive: {}, damage taken: {}, state hash: {:016x}", game.get_map().get_enemies().size(), game.get_damage_taken(),
+			game.compute_state_hash());
+	if (replay_path && !game.get_replay().write(replay_path))
+	{
+		BLT_ERROR("Unable to write replay '{}'", replay_path);
+		return 1;
+	}
+
+	// the renderer only ever sees the instance buffer, checking it here covers the draw path without a GL context
+	game.publish_instances();
+	const auto& instances = game.get_enemy_instances().get_front();
+	const auto& positions = game.get_map().get_enemy_positions();
+	if (instances.size() != positions.size())
+	{
+		BLT_ERROR("Instance buffer holds {} sprites for {} enemies", instances.size(), positions.size());
+		return 1;
+	}
+	for (blt::size_t i = 0; i < instances.size(); ++i)
+	{
+		if (instances[i].x != positions[i].x() || instances[i].y != positions[i].y())
+		{
+			BLT_ERROR("Sprite {} is not at its enemy's position", i);
+			return 1;
+		}
+	}
+	return 0;
+}
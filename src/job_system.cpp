@@ -0,0 +1,129 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <job_system.h>
+#include <algorithm>
+
+namespace td
+{
+	job_system_t::job_system_t(const blt::size_t worker_count)
+	{
+		// one queue per worker, plus one for threads outside the pool which submit work
+		for (blt::size_t i = 0; i < worker_count + 1; ++i)
+			m_queues.push_back(std::make_unique<job_queue_t>());
+		m_workers.reserve(worker_count);
+		for (blt::size_t i = 0; i < worker_count; ++i)
+			m_workers.emplace_back(&job_system_t::worker_main, this, i);
+	}
+
+	job_system_t::~job_system_t()
+	{
+		{
+			std::lock_guard lock{m_sleep_mutex};
+			m_running = false;
+		}
+		m_wake.notify_all();
+		for (auto& worker : m_workers)
+			worker.join();
+	}
+
+	void job_system_t::run_jobs(const job_func_t func, void* context, const blt::size_t count, const blt::size_t grain)
+	{
+		const auto job_count = (count + grain - 1) / grain;
+		std::atomic<blt::size_t> remaining{job_count};
+
+		// counted before the jobs are visible so a worker popping one can never take the count below zero
+		{
+			std::lock_guard lock{m_sleep_mutex};
+			m_queued += job_count;
+		}
+		// deal the ranges out round robin so every worker starts with something local
+		for (blt::size_t i = 0; i < job_count; ++i)
+		{
+			const auto begin = i * grain;
+			const job_t job{func, context, begin, std::min(begin + grain, count), &remaining};
+			auto& queue = *m_queues[i % m_queues.size()];
+			std::lock_guard lock{queue.mutex};
+			queue.jobs.push_back(job);
+		}
+		m_wake.notify_all();
+
+		// help out until everything we submitted has finished
+		const auto own_queue = m_queues.size() - 1;
+		while (remaining.load(std::memory_order_acquire) != 0)
+		{
+			job_t job{};
+			if (pop(own_queue, job) || steal(own_queue, job))
+				run(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void job_system_t::worker_main(const blt::size_t index)
+	{
+		while (true)
+		{
+			job_t job{};
+			if (pop(index, job) || steal(index, job))
+			{
+				run(job);
+				continue;
+			}
+			std::unique_lock lock{m_sleep_mutex};
+			m_wake.wait(lock, [this]() {
+				return !m_running || m_queued.load() != 0;
+			});
+			if (!m_running)
+				return;
+		}
+	}
+
+	bool job_system_t::pop(const blt::size_t queue, job_t& job)
+	{
+		auto& own = *m_queues[queue];
+		std::lock_guard lock{own.mutex};
+		if (own.jobs.empty())
+			return false;
+		job = own.jobs.back();
+		own.jobs.pop_back();
+		--m_queued;
+		return true;
+	}
+
+	bool job_system_t::steal(const blt::size_t thief, job_t& job)
+	{
+		for (blt::size_t offset = 1; offset < m_queues.size(); ++offset)
+		{
+			auto& victim = *m_queues[(thief + offset) % m_queues.size()];
+			std::lock_guard lock{victim.mutex};
+			if (victim.jobs.empty())
+				continue;
+			job = victim.jobs.front();
+			victim.jobs.pop_front();
+			--m_queued;
+			return true;
+		}
+		return false;
+	}
+
+	void job_system_t::run(const job_t& job)
+	{
+		job.func(job.context, job.begin, job.end);
+		job.remaining->fetch_sub(1, std::memory_order_release);
+	}
+}
@@ -3,9 +3,17 @@
 #include "blt/gfx/renderer/batch_2d_renderer.h"
 #include "blt/gfx/renderer/camera.h"
 #include "blt/gfx/renderer/resource_manager.h"
-#include <map.h>
+#include <blt/gfx/texture.h>
+#include <game.h>
+#include <allocation_tracker.h>
+#include <particles.h>
+#include <resource_loader.h>
+#include <profiler.h>
+#include <sprite_renderer.h>
 
 #include <blt/math/aabb.h>
+#include <algorithm>
+#include <cstring>
 
 blt::gfx::matrix_state_manager global_matrices;
 blt::gfx::resource_manager resources;
@@ -20,30 +28,102 @@ blt::gfx::curve2d_t curve2{blt::vec2{250, 250}, blt::vec2{500, 500}, blt::vec2{7
 blt::gfx::curve2d_mesh_data_t mesh;
 blt::gfx::curve2d_mesh_data_t mesh2;
 
-using curve_t = blt::gfx::curve2d_t;
-using vec2 = blt::vec2f;
-curve_t c1{{0, 100}, {200, 100}};
-curve_t c2{{200, 100}, {300, 100}, {300, 300}};
-curve_t c3{{300, 300}, {300, 400}, {400, 400}};
-curve_t c4{{400, 400}, {500, 400}, {500, 500}};
+td::job_system_t jobs;
+td::sprite_renderer_t sprites;
+td::game_t game{td::make_default_path()};
+td::particle_system_t particles;
+// rebuilt every frame, keeps its capacity so steady state frames don't allocate
+std::vector<td::sprite_instance_t> particle_instances;
+
+// time per frame spent handing streamed textures to GL
+constexpr blt::u64 TEXTURE_UPLOAD_BUDGET_NS = 2'000'000;
+// sprite texture layers. The enemy database's interned textures take the layers from 0, particles and towers the last two.
+constexpr blt::u32 PARTICLE_TEXTURE = td::sprite_renderer_t::MAX_TEXTURES - 1;
+constexpr blt::u32 TOWER_TEXTURE = td::sprite_renderer_t::MAX_TEXTURES - 2;
+// enemy texture layers which got an image of their own, the rest show no_enemy_texture
+std::vector<bool> enemy_texture_loaded;
+
+// runs on the loader's threads
+bool decode_texture(void*, const std::string& path, td::image_t& image)
+{
+	blt::gfx::texture_file file{path};
+	const auto& data = file.texture();
+	if (data.data() == nullptr)
+		return false;
+	image.width = static_cast<blt::u32>(data.width());
+	image.height = static_cast<blt::u32>(data.height());
+	image.channels = static_cast<blt::u32>(data.channels());
+	image.pixels.resize(static_cast<blt::size_t>(image.width) * image.height * image.channels);
+	std::memcpy(image.pixels.data(), data.data(), image.pixels.size());
+	return true;
+}
+
+// runs on the main thread, which owns the GL context. Hands the image to every sprite texture layer using it.
+void upload_texture(void*, const std::string& name, const td::image_t& image)
+{
+	if (name == "particle")
+		sprites.set_texture(PARTICLE_TEXTURE, image);
+	else if (name == "tower")
+		sprites.set_texture(TOWER_TEXTURE, image);
+
+	const auto& database = game.get_database();
+	const auto count = std::min(database.get_texture_count(), TOWER_TEXTURE);
+	enemy_texture_loaded.resize(count, false);
+	const bool fallback = name == "no_enemy_texture";
+	for (blt::u32 texture = 0; texture < count; ++texture)
+	{
+		if (database.get_texture_name(texture) == name)
+		{
+			sprites.set_texture(texture, image);
+			enemy_texture_loaded[texture] = true;
+		} else if (fallback && !enemy_texture_loaded[texture])
+			sprites.set_texture(texture, image);
+	}
+}
 
-td::enemy_database_t database;
-td::map_t map{std::vector{td::path_segment_t{c1}, td::path_segment_t{c2}, td::path_segment_t{c3}, td::path_segment_t{c4}}, database};
+td::resource_loader_t loader{decode_texture, upload_texture};
 
 void init(const blt::gfx::window_data&)
 {
 	blt::gfx::setWindowSize(1440, 720);
 	using namespace blt::gfx;
 
-	resources.setPrefixDirectory("../");
+	// decoding starts right away and overlaps with the rest of init. Only the critical textures hold up the first frame,
+	// the rest stream in while the game runs.
 	BLT_INFO("Loading Resources");
-	resources.enqueue("res/enemy.png", "no_enemy_texture");
-	resources.enqueue("res/particle.png", "particle");
-	resources.enqueue("res/tower.png", "tower");
+	particles.set_texture(PARTICLE_TEXTURE);
+	game.get_towers().set_texture(TOWER_TEXTURE);
+	loader.enqueue("../res/enemy.png", "no_enemy_texture", td::resource_priority_t::CRITICAL);
+	loader.enqueue("../res/particle.png", "particle");
+	loader.enqueue("../res/tower.png", "tower");
+	loader.start();
+
+	// enemies.bin is compiled from res/enemies.txt next to the executable, fall back to the text source and then the built in definitions
+	if (!game.get_database().load_binary("enemies.bin"))
+		game.get_database().load_text("../res/enemies.txt");
+	game.get_map().set_job_system(&jobs);
+	particles.subscribe(game.get_events());
+	game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST, 50, 1.5f, 0}});
+	game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST_SPLITTER, 25, 0.5f, 30}});
+	game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST, 200, 0.05f, 45}});
+	for (const auto& tower : {td::tower_placement_t{td::tower_id_t::BASIC, 400, 350}, td::tower_placement_t{td::tower_id_t::SNIPER, 500, 150},
+								td::tower_placement_t{td::tower_id_t::LOVE, 600, 350}})
+	{
+		td::input_t input{0, td::input_type_t::PLACE_TOWER};
+		input.tower = tower;
+		game.queue_input(input);
+	}
 
 	global_matrices.create_internals();
-	resources.load_resources();
 	renderer_2d.create();
+	// uploads go straight into the sprite renderer's texture array, it has to exist first
+	sprites.create();
+	if (game.get_database().get_texture_count() > TOWER_TEXTURE)
+		BLT_WARN("{} enemy textures, only the first {} get a sprite texture", game.get_database().get_texture_count(), TOWER_TEXTURE);
+	{
+		TD_PROFILE_ZONE("resource load");
+		loader.finish_critical();
+	}
 	mesh = curve.to_mesh(32);
 	mesh2 = curve2.to_mesh(32);
 }
@@ -52,19 +132,55 @@ void update(const blt::gfx::window_data& data)
 {
 	global_matrices.update_perspectives(data.width, data.height, 90, 0.1, 2000);
 
-	camera.update();
-	camera.update_view(global_matrices);
-	global_matrices.update();
+	{
+		TD_PROFILE_ZONE("camera");
+		camera.update();
+		camera.update_view(global_matrices);
+		global_matrices.update();
+	}
 
-	map.update();
-	map.draw(renderer_2d);
+	if (!loader.is_done())
+	{
+		{
+			TD_PROFILE_ZONE("resource stream");
+			loader.upload(TEXTURE_UPLOAD_BUDGET_NS);
+		}
+		ImGui::Begin("Loading");
+		ImGui::ProgressBar(loader.get_progress());
+		ImGui::Text("%zu / %zu textures, %zu decoded", loader.get_uploaded(), loader.get_total(), loader.get_decoded());
+		for (const auto& failure : loader.get_failures())
+			ImGui::Text("failed: %s", failure.c_str());
+		ImGui::End();
+	}
+
+	{
+		TD_PROFILE_ZONE("game update");
+		game.update(static_cast<float>(blt::gfx::getFrameDeltaSeconds()));
+	}
+	{
+		TD_PROFILE_ZONE("particles");
+		particles.step(static_cast<float>(blt::gfx::getFrameDeltaSeconds()));
+		particle_instances.clear();
+		particles.write_instances(particle_instances);
+	}
+	const td::allocation_tracker::scope_t render_allocations;
+	{
+		TD_PROFILE_ZONE("game render");
+		game.render(renderer_2d);
+	}
+	if constexpr (td::allocation_tracker::is_enabled())
+	{
+		// should read zero once the renderer's buffers have grown to fit a frame
+		ImGui::Begin("Allocations");
+		ImGui::Text("game render: %llu allocations this frame", static_cast<unsigned long long>(render_allocations.get_allocations()));
+		ImGui::End();
+	}
 
 	t += 0.01f * dir;
 	if (t >= 1)
 	{
 		t = 1;
 		dir = -1;
-		map.spawn(td::enemy_id_t::TEST);
 	} else if (t <= 0)
 	{
 		t = 0;
@@ -79,7 +195,46 @@ void update(const blt::gfx::window_data& data)
 	// for (const auto& line : lines)
 	// renderer_2d.drawLineInternal(blt::make_color(0, 1,0), line);
 
-	renderer_2d.render(data.width, data.height);
+	{
+		TD_PROFILE_ZONE("renderer_2d render");
+		renderer_2d.render(data.width, data.height);
+	}
+	{
+		TD_PROFILE_ZONE("sprite render");
+		sprites.render(game.get_enemy_instances().get_front());
+		sprites.render(particle_instances);
+	}
+
+	if constexpr (td::profiler::is_enabled())
+	{
+		// this frame's zones show up in the next frame's numbers, the overlay itself is drawn after the renderers ran
+		td::profiler::end_frame();
+		ImGui::Begin("Profiler");
+		if (ImGui::Button("Write trace.json"))
+			td::profiler::write_chrome_trace("trace.json");
+		if (ImGui::BeginTable("zones", 4))
+		{
+			ImGui::TableSetupColumn("zone");
+			ImGui::TableSetupColumn("last ms");
+			ImGui::TableSetupColumn("avg ms");
+			ImGui::TableSetupColumn("max ms");
+			ImGui::TableHeadersRow();
+			for (const auto& zone : td::profiler::get_stats())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(zone.name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", zone.last_ms);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", zone.average_ms);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", zone.max_ms);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
 }
 
 void destroy(const blt::gfx::window_data&)
@@ -87,6 +242,7 @@ void destroy(const blt::gfx::window_data&)
 	global_matrices.cleanup();
 	resources.cleanup();
 	renderer_2d.cleanup();
+	sprites.cleanup();
 	blt::gfx::cleanup();
 }
 
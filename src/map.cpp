@@ -17,13 +17,80 @@
  */
 #include <config.h>
 #include <map.h>
-#include <blt/gfx/window.h>
+#include <profiler.h>
+#include <blt/std/assert.h>
+#include <algorithm>
 
 namespace td
 {
-	path_segment_t::path_segment_t(const blt::gfx::curve2d_t& curve): m_bounding_box{get_bounding_box(curve, PATH_UPDATE_SEGMENTS)}, m_curve{curve},
-																	m_curve_length{curve.length(PATH_UPDATE_SEGMENTS)}
-	{}
+	// number of parameter space steps taken per table entry when measuring the curve
+	constexpr blt::i32 ARC_LENGTH_OVERSAMPLING = 8;
+	// enemies per parallel job. Kept a multiple of 8 so every enemy goes through the same SIMD lane code in both the serial
+	// and parallel update, which keeps the two bit identical.
+	constexpr blt::size_t ENEMY_CHUNK_SIZE = 4096;
+
+	path_segment_t::path_segment_t(const blt::gfx::curve2d_t& curve): m_bounding_box{get_bounding_box(curve, PATH_UPDATE_SEGMENTS)}, m_curve{curve}
+	{
+		bake_arc_length_table(std::max(PATH_UPDATE_SEGMENTS, 1));
+	}
+
+	void path_segment_t::bake_arc_length_table(const blt::i32 segments)
+	{
+		// walk the curve in small parameter steps, recording the distance travelled at each step
+		const auto samples = static_cast<blt::size_t>(segments) * ARC_LENGTH_OVERSAMPLING;
+		std::vector<blt::vec2> points;
+		std::vector<float> distances;
+		points.reserve(samples + 1);
+		distances.reserve(samples + 1);
+		points.push_back(m_curve.get_point(0));
+		distances.push_back(0);
+		for (blt::size_t i = 1; i <= samples; ++i)
+		{
+			const auto point = m_curve.get_point(static_cast<float>(i) / static_cast<float>(samples));
+			distances.push_back(distances.back() + (point - points.back()).magnitude());
+			points.push_back(point);
+		}
+		m_curve_length = distances.back();
+
+		// then resample the walk so table entries are evenly spaced by distance rather than by parameter
+		m_arc_step = m_curve_length / static_cast<float>(segments);
+		m_inv_arc_step = m_arc_step > 0 ? 1.0f / m_arc_step : 0.0f;
+		m_arc_points.resize(static_cast<blt::size_t>(segments) + 1);
+		blt::size_t j = 0;
+		for (blt::size_t k = 0; k < m_arc_points.size(); ++k)
+		{
+			const auto target = static_cast<float>(k) * m_arc_step;
+			while (j + 2 < distances.size() && distances[j + 1] < target)
+				++j;
+			const auto span = distances[j + 1] - distances[j];
+			const auto t = span > 0 ? std::clamp((target - distances[j]) / span, 0.0f, 1.0f) : 0.0f;
+			m_arc_points[k] = points[j] + (points[j + 1] - points[j]) * t;
+		}
+		m_arc_points.back() = points.back();
+	}
+
+	blt::vec2 path_segment_t::get_point(const float distance) const
+	{
+		const auto last = static_cast<float>(m_arc_points.size() - 1);
+		const auto scaled = std::clamp(distance * m_inv_arc_step, 0.0f, last);
+		const auto index = std::min(static_cast<blt::size_t>(scaled), m_arc_points.size() - 2);
+		const auto t = scaled - static_cast<float>(index);
+		return m_arc_points[index] + (m_arc_points[index + 1] - m_arc_points[index]) * t;
+	}
+
+	void path_segment_t::get_points(const float* distances, blt::vec2* points, const blt::size_t count) const
+	{
+		const auto last = static_cast<float>(m_arc_points.size() - 1);
+		const auto last_index = m_arc_points.size() - 2;
+		const auto* table = m_arc_points.data();
+		for (blt::size_t i = 0; i < count; ++i)
+		{
+			const auto scaled = std::clamp(distances[i] * m_inv_arc_step, 0.0f, last);
+			const auto index = std::min(static_cast<blt::size_t>(scaled), last_index);
+			const auto t = scaled - static_cast<float>(index);
+			points[i] = table[index] + (table[index + 1] - table[index]) * t;
+		}
+	}
 
 	bounding_box_t path_segment_t::get_bounding_box(const blt::gfx::curve2d_t& curve, const blt::i32 segments)
 	{
@@ -44,54 +111,290 @@ namespace td
 		return bounding_box_t{min, max};
 	}
 
-	float map_t::update()
+	std::vector<path_segment_t> make_default_path()
+	{
+		using curve_t = blt::gfx::curve2d_t;
+		return std::vector{
+			path_segment_t{curve_t{{0, 100}, {200, 100}}},
+			path_segment_t{curve_t{{200, 100}, {300, 100}, {300, 300}}},
+			path_segment_t{curve_t{{300, 300}, {300, 400}, {400, 400}}},
+			path_segment_t{curve_t{{400, 400}, {500, 400}, {500, 500}}}
+		};
+	}
+
+	map_t::map_t(const std::vector<path_segment_t>& path_segments, enemy_database_t& database): m_path_segments{path_segments},
+																							m_database{&database}
+	{
+		// find_segment() and get_point() index the first segment unconditionally
+		BLT_ASSERT_MSG(!m_path_segments.empty(), "a map needs at least one path segment");
+		m_segment_starts.reserve(m_path_segments.size() + 1);
+		m_segment_starts.push_back(0);
+		for (const auto& segment : m_path_segments)
+			m_segment_starts.push_back(m_segment_starts.back() + segment.get_length());
+	}
+
+	enemy_handle_t map_t::spawn(const enemy_id_t id, const float distance)
+	{
+		const auto& stats = m_database->get_stats(id);
+		enemy_instance_t enemy{id, stats.health};
+		enemy.distance_along_path = distance;
+		m_sorted_dirty = true;
+		return m_enemies.add(enemy, stats.speed * m_speed_multiplier, stats.resistance);
+	}
+
+	void map_t::spawn_batch(const std::vector<wave_spawn_t>& spawns)
+	{
+		TD_PROFILE_ZONE("spawn batch");
+		if (spawns.empty())
+			return;
+		m_wave_spawns.clear();
+		for (const auto& spawn : spawns)
+		{
+			const auto& stats = m_database->get_stats(spawn.enemy);
+			const auto speed = stats.speed * m_speed_multiplier;
+			enemy_instance_t enemy{spawn.enemy, stats.health};
+			enemy.distance_along_path = speed * spawn.age;
+			m_wave_spawns.push(enemy, speed, stats.resistance);
+		}
+		m_enemies.add_batch(m_wave_spawns);
+		m_sorted_dirty = true;
+	}
+
+	float map_t::step(const float dt)
 	{
+		TD_PROFILE_ZONE("map step");
 		float damage = 0;
-		for (blt::size_t i = 0; i < m_path_segments.size(); ++i)
+		const auto count = m_enemies.size();
+		const auto total_length = get_total_length();
+		const bool parallel = m_jobs != nullptr && count > ENEMY_CHUNK_SIZE;
+		m_crossed.clear();
+		// segment boundaries don't matter while moving, an enemy only leaves the map once it passes the end of the whole path
+		if (parallel)
 		{
-			auto& segment = m_path_segments[i];
-			const auto length = segment.m_curve_length;
-			for (const auto [j, enemy] : blt::enumerate(segment.m_enemies))
-			{
-				if (!enemy.is_alive)
-					continue;
-				const auto& enemy_info = m_database->get(enemy.id);
-				const auto movement = (enemy_info.get_speed() / length) * PATH_SPEED_MULTIPLIER * blt::gfx::getFrameDeltaSeconds();
-				enemy.percent_along_path += static_cast<float>(movement);
-				if (enemy.percent_along_path >= 1)
+			// phase one: chunks advance independently, each writing to its own crossed list
+			const auto chunk_count = (count + ENEMY_CHUNK_SIZE - 1) / ENEMY_CHUNK_SIZE;
+			m_chunk_crossed.resize(chunk_count);
+			m_jobs->parallel_for(chunk_count, 1, [this, dt, count, total_length](const blt::size_t begin, const blt::size_t end) {
+				TD_PROFILE_ZONE("advance chunk");
+				for (auto chunk = begin; chunk < end; ++chunk)
 				{
-					enemy.is_alive = false;
-					segment.m_empty_indices.emplace_back(j);
-					if (i != m_path_segments.size() - 1)
-					{
-						auto& next_segment = m_path_segments[i + 1];
-						enemy_instance_t moved_enemy{enemy.id, enemy.health_left};
-						next_segment.add_enemy(moved_enemy);
-					} else
-						damage += enemy_info.get_damage();
+					auto& crossed = m_chunk_crossed[chunk];
+					crossed.clear();
+					const auto first = chunk * ENEMY_CHUNK_SIZE;
+					m_enemies.advance(dt, total_length, first, std::min(first + ENEMY_CHUNK_SIZE, count), crossed);
 				}
-			}
+			});
+			// phase two: merge in chunk order, giving the same increasing index list the serial path produces
+			for (blt::size_t chunk = 0; chunk < chunk_count; ++chunk)
+				m_crossed.insert(m_crossed.end(), m_chunk_crossed[chunk].begin(), m_chunk_crossed[chunk].end());
+		} else
+		{
+			TD_PROFILE_ZONE("advance chunk");
+			m_enemies.advance(dt, total_length, m_crossed);
+		}
+		for (const auto i : m_crossed)
+		{
+			const auto id = m_enemies.get_ids()[i];
+			const auto enemy_damage = m_database->get_stats(id).damage;
+			damage += enemy_damage;
+			if (m_events)
+				m_events->push(enemy_leaked_event_t{id, enemy_damage});
+		}
+		m_enemies.remove_sorted(m_crossed);
+		m_sorted_dirty = true;
+
+		m_enemy_positions.resize(m_enemies.size());
+		const auto* distances = m_enemies.get_distance_along_path().data();
+		if (parallel)
+		{
+			m_jobs->parallel_for(m_enemy_positions.size(), ENEMY_CHUNK_SIZE, [this, distances](const blt::size_t begin, const blt::size_t end) {
+				TD_PROFILE_ZONE("enemy positions");
+				get_points(distances + begin, m_enemy_positions.data() + begin, end - begin);
+			});
+		} else
+		{
+			TD_PROFILE_ZONE("enemy positions");
+			get_points(distances, m_enemy_positions.data(), m_enemy_positions.size());
+		}
+		{
+			TD_PROFILE_ZONE("enemy grid rebuild");
+			m_enemy_grid.rebuild(m_enemy_positions);
 		}
 
 		return damage;
 	}
 
-	void map_t::draw(blt::gfx::batch_renderer_2d& renderer)
+	void map_t::apply_damage(const std::vector<hit_t>& hits)
 	{
-		// TODO: this is currently for debug
-		const auto mesh_data = get_mesh_data(10);
-		renderer.drawCurve(mesh_data, blt::make_color(0, 1, 0));
-		for (const auto& segment : m_path_segments)
+		TD_PROFILE_ZONE("apply damage");
+		m_killed.clear();
+		m_damage_resolver.resolve(m_enemies, hits, m_killed);
+		if (m_killed.empty())
+			return;
+		// the events and the swap and pop below index positions by dense index
+		sync_positions();
+		const auto& ids = m_enemies.get_ids();
+		const auto& distances = m_enemies.get_distance_along_path();
+		// children take the parent's place on the path. They are gathered before the parents are removed and inserted in one batch after.
+		m_child_spawns.clear();
+		for (const auto i : m_killed)
 		{
-			for (const auto& enemy : segment.m_enemies)
+			for (const auto child : m_database->get_children(ids[i]))
 			{
-				if (!enemy.is_alive)
-					continue;
-				const auto point = segment.m_curve.get_point(enemy.percent_along_path);
-				constexpr blt::vec2f size{10, 10};
-				renderer.drawRectangle(blt::gfx::rectangle2d_t{point, size}, blt::make_color(1, 0, 0), 1);
+				const auto& stats = m_database->get_stats(child);
+				enemy_instance_t enemy{child, stats.health};
+				enemy.distance_along_path = distances[i];
+				m_child_spawns.push(enemy, stats.speed * m_speed_multiplier, stats.resistance);
 			}
 		}
+		if (m_events)
+		{
+			for (const auto i : m_killed)
+			{
+				const auto& point = m_enemy_positions[i];
+				m_events->push(enemy_died_event_t{ids[i], point.x(), point.y(), distances[i]});
+			}
+		}
+		// mirror the store's swap and pop so positions keep matching dense indices
+		for (auto it = m_killed.rbegin(); it != m_killed.rend(); ++it)
+		{
+			m_enemy_positions[*it] = m_enemy_positions.back();
+			m_enemy_positions.pop_back();
+		}
+		m_enemies.remove_sorted(m_killed);
+		if (!m_child_spawns.empty())
+		{
+			const auto first = m_enemy_positions.size();
+			m_enemies.add_batch(m_child_spawns);
+			m_enemy_positions.resize(m_enemies.size());
+			get_points(m_child_spawns.distance_along_path.data(), m_enemy_positions.data() + first, m_child_spawns.size());
+		}
+		m_enemy_grid.rebuild(m_enemy_positions);
+		m_sorted_dirty = true;
+	}
+
+	void map_t::sync_positions()
+	{
+		const auto first = m_enemy_positions.size();
+		if (first >= m_enemies.size())
+			return;
+		m_enemy_positions.resize(m_enemies.size());
+		get_points(m_enemies.get_distance_along_path().data() + first, m_enemy_positions.data() + first, m_enemy_positions.size() - first);
+	}
+
+	void map_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		m_enemies.write_snapshot(writer);
+		writer.write(m_enemy_positions);
+		writer.write(m_speed_multiplier);
+	}
+
+	bool map_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		if (!m_enemies.read_snapshot(reader) || !reader.read(m_enemy_positions) || !reader.read(m_speed_multiplier))
+			return false;
+		// positions lag the store between a spawn and the next step, so they can legitimately be shorter
+		if (m_enemy_positions.size() > m_enemies.size())
+			return false;
+		m_enemy_grid.rebuild(m_enemy_positions);
+		m_sorted_dirty = true;
+		return true;
+	}
+
+	void map_t::draw(blt::gfx::batch_renderer_2d& renderer)
+	{
+		TD_PROFILE_ZONE("map draw");
+		// TODO: this is currently for debug
+		renderer.drawCurve(get_path_mesh(10), blt::make_color(0, 1, 0));
+	}
+
+	void map_t::write_instances(std::vector<sprite_instance_t>& instances) const
+	{
+		TD_PROFILE_ZONE("write instances");
+		constexpr float size = 10;
+		const auto& ids = m_enemies.get_ids();
+		const auto offset = instances.size();
+		instances.resize(offset + m_enemy_positions.size());
+		for (blt::size_t i = 0; i < m_enemy_positions.size(); ++i)
+		{
+			const auto& point = m_enemy_positions[i];
+			instances[offset + i] = sprite_instance_t{point.x(), point.y(), size, m_database->get_texture_index(ids[i]), 1, 0, 0, 1};
+		}
+	}
+
+	blt::size_t map_t::find_segment(const float distance) const
+	{
+		// first segment starting after the distance, the one before it contains the distance
+		const auto it = std::upper_bound(m_segment_starts.begin() + 1, m_segment_starts.end() - 1, distance);
+		return static_cast<blt::size_t>(it - m_segment_starts.begin()) - 1;
+	}
+
+	blt::vec2 map_t::get_point(const float distance) const
+	{
+		const auto segment = find_segment(distance);
+		return m_path_segments[segment].get_point(distance - m_segment_starts[segment]);
+	}
+
+	void map_t::get_points(const float* distances, blt::vec2* points, const blt::size_t count) const
+	{
+		for (blt::size_t i = 0; i < count; ++i)
+		{
+			const auto segment = find_segment(distances[i]);
+			points[i] = m_path_segments[segment].get_point(distances[i] - m_segment_starts[segment]);
+		}
+	}
+
+	const std::vector<map_t::sorted_enemy_t>& map_t::get_sorted_view()
+	{
+		if (!m_sorted_dirty)
+			return m_sorted;
+		const auto& distances = m_enemies.get_distance_along_path();
+		m_sorted.resize(distances.size());
+		for (blt::size_t i = 0; i < distances.size(); ++i)
+			m_sorted[i] = sorted_enemy_t{distances[i], static_cast<blt::u32>(i)};
+		std::sort(m_sorted.begin(), m_sorted.end(), [](const sorted_enemy_t& a, const sorted_enemy_t& b) {
+			return a.distance < b.distance;
+		});
+		m_sorted_dirty = false;
+		return m_sorted;
+	}
+
+	std::pair<blt::size_t, blt::size_t> map_t::get_sorted_range(const float min_distance, const float max_distance)
+	{
+		const auto& sorted = get_sorted_view();
+		const auto begin = std::lower_bound(sorted.begin(), sorted.end(), min_distance, [](const sorted_enemy_t& a, const float value) {
+			return a.distance < value;
+		});
+		const auto end = std::upper_bound(begin, sorted.end(), max_distance, [](const float value, const sorted_enemy_t& a) {
+			return value < a.distance;
+		});
+		return {static_cast<blt::size_t>(begin - sorted.begin()), static_cast<blt::size_t>(end - sorted.begin())};
+	}
+
+	blt::u32 map_t::find_first(const float min_distance, const float max_distance)
+	{
+		const auto [begin, end] = get_sorted_range(min_distance, max_distance);
+		return begin == end ? enemy_store_t::INVALID_INDEX : m_sorted[end - 1].index;
+	}
+
+	blt::u32 map_t::find_last(const float min_distance, const float max_distance)
+	{
+		const auto [begin, end] = get_sorted_range(min_distance, max_distance);
+		return begin == end ? enemy_store_t::INVALID_INDEX : m_sorted[begin].index;
+	}
+
+	blt::u32 map_t::find_strongest(const float min_distance, const float max_distance)
+	{
+		const auto [begin, end] = get_sorted_range(min_distance, max_distance);
+		const auto& health = m_enemies.get_health_left();
+		auto strongest = enemy_store_t::INVALID_INDEX;
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto index = m_sorted[i].index;
+			if (strongest == enemy_store_t::INVALID_INDEX || health[index] > health[strongest])
+				strongest = index;
+		}
+		return strongest;
 	}
 
 	blt::gfx::curve2d_mesh_data_t map_t::get_mesh_data(const float thickness) const
@@ -101,4 +404,16 @@ namespace td
 			mesh_data.with(segment.m_curve.to_mesh(PATH_DRAW_SEGMENTS, thickness));
 		return mesh_data;
 	}
+
+	const blt::gfx::curve2d_mesh_data_t& map_t::get_path_mesh(const float thickness)
+	{
+		if (m_path_mesh_segments != PATH_DRAW_SEGMENTS || m_path_mesh_thickness != thickness)
+		{
+			TD_PROFILE_ZONE("path mesh build");
+			m_path_mesh = get_mesh_data(thickness);
+			m_path_mesh_thickness = thickness;
+			m_path_mesh_segments = PATH_DRAW_SEGMENTS;
+		}
+		return m_path_mesh;
+	}
 }
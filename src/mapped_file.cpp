@@ -0,0 +1,108 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <mapped_file.h>
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define TD_HAS_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace td
+{
+	mapped_file_t::mapped_file_t(mapped_file_t&& move) noexcept: m_data(std::exchange(move.m_data, nullptr)), m_size(std::exchange(move.m_size, 0)),
+																m_mapped(std::exchange(move.m_mapped, false)), m_fallback(std::move(move.m_fallback))
+	{}
+
+	mapped_file_t& mapped_file_t::operator=(mapped_file_t&& move) noexcept
+	{
+		if (this != &move)
+		{
+			close();
+			m_data = std::exchange(move.m_data, nullptr);
+			m_size = std::exchange(move.m_size, 0);
+			m_mapped = std::exchange(move.m_mapped, false);
+			m_fallback = std::move(move.m_fallback);
+		}
+		return *this;
+	}
+
+	mapped_file_t::~mapped_file_t()
+	{
+		close();
+	}
+
+	bool mapped_file_t::open(const std::string& path)
+	{
+		close();
+#ifdef TD_HAS_MMAP
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info{};
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			::close(fd);
+			return false;
+		}
+		void* mapping = mmap(nullptr, static_cast<blt::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		// the mapping keeps its own reference to the file
+		::close(fd);
+		if (mapping == MAP_FAILED)
+			return false;
+		m_data = mapping;
+		m_size = static_cast<blt::size_t>(info.st_size);
+		m_mapped = true;
+		return true;
+#else
+		std::ifstream file{path, std::ios::binary | std::ios::ate};
+		if (!file)
+			return false;
+		const auto size = static_cast<blt::size_t>(file.tellg());
+		if (size == 0)
+			return false;
+		// stored as words so the contents are at least 4 byte aligned, like a mapping would be
+		m_fallback.resize((size + sizeof(blt::u32) - 1) / sizeof(blt::u32));
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(m_fallback.data()), static_cast<std::streamsize>(size)))
+		{
+			m_fallback.clear();
+			return false;
+		}
+		m_data = m_fallback.data();
+		m_size = size;
+		return true;
+#endif
+	}
+
+	void mapped_file_t::close()
+	{
+#ifdef TD_HAS_MMAP
+		if (m_mapped)
+			munmap(const_cast<void*>(m_data), m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+		m_mapped = false;
+		m_fallback.clear();
+	}
+}
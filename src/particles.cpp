@@ -0,0 +1,201 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <particles.h>
+#include <profiler.h>
+#include <simd.h>
+#include <algorithm>
+#include <cmath>
+
+namespace td
+{
+	namespace
+	{
+		// fraction of its speed a particle loses per second
+		constexpr float PARTICLE_DRAG = 3;
+		constexpr float TWO_PI = 6.28318530718f;
+	}
+
+	particle_pool_t::particle_pool_t(const blt::size_t capacity): m_capacity{capacity}
+	{
+		pool_layout_t layout;
+		const auto x = layout.add<float>(capacity);
+		const auto y = layout.add<float>(capacity);
+		const auto vx = layout.add<float>(capacity);
+		const auto vy = layout.add<float>(capacity);
+		const auto age = layout.add<float>(capacity);
+		const auto lifetime = layout.add<float>(capacity);
+		const auto sprite_size = layout.add<float>(capacity);
+		const auto r = layout.add<float>(capacity);
+		const auto g = layout.add<float>(capacity);
+		const auto b = layout.add<float>(capacity);
+		m_block = pool_block_t{layout};
+		m_x = m_block.get<float>(x);
+		m_y = m_block.get<float>(y);
+		m_vx = m_block.get<float>(vx);
+		m_vy = m_block.get<float>(vy);
+		m_age = m_block.get<float>(age);
+		m_lifetime = m_block.get<float>(lifetime);
+		m_sprite_size = m_block.get<float>(sprite_size);
+		m_r = m_block.get<float>(r);
+		m_g = m_block.get<float>(g);
+		m_b = m_block.get<float>(b);
+	}
+
+	void particle_pool_t::spawn(const blt::vec2& position, const blt::vec2& velocity, const float lifetime, const float size, const float r,
+								const float g, const float b)
+	{
+		if (m_capacity == 0)
+			return;
+		// a full ring recycles its oldest particle
+		if (m_size == m_capacity)
+		{
+			m_tail = m_tail + 1 == m_capacity ? 0 : m_tail + 1;
+			--m_size;
+		}
+		auto i = m_tail + m_size;
+		if (i >= m_capacity)
+			i -= m_capacity;
+		++m_size;
+		m_x[i] = position.x();
+		m_y[i] = position.y();
+		m_vx[i] = velocity.x();
+		m_vy[i] = velocity.y();
+		m_age[i] = 0;
+		m_lifetime[i] = lifetime;
+		m_sprite_size[i] = size;
+		m_r[i] = r;
+		m_g[i] = g;
+		m_b[i] = b;
+	}
+
+	template <typename Func>
+	void particle_pool_t::for_each_span(Func&& func) const
+	{
+		// the ring is at most two contiguous runs, the tail up to the end of the arrays and then the wrapped part from the start
+		const auto first_end = std::min(m_tail + m_size, m_capacity);
+		if (m_tail < first_end)
+			func(m_tail, first_end);
+		const auto wrapped = m_tail + m_size - first_end;
+		if (wrapped > 0)
+			func(static_cast<blt::size_t>(0), wrapped);
+	}
+
+	void particle_pool_t::step(const float dt)
+	{
+		TD_PROFILE_ZONE("particle step");
+		const auto damping = std::max(0.0f, 1 - PARTICLE_DRAG * dt);
+		for_each_span([this, dt, damping](const blt::size_t begin, const blt::size_t end) {
+			step_span(begin, end, dt, damping);
+		});
+		while (m_size > 0 && m_age[m_tail] >= m_lifetime[m_tail])
+		{
+			m_tail = m_tail + 1 == m_capacity ? 0 : m_tail + 1;
+			--m_size;
+		}
+	}
+
+	void particle_pool_t::step_span(const blt::size_t begin, const blt::size_t end, const float dt, const float damping)
+	{
+		auto i = begin;
+#if defined(TD_SIMD_AVX)
+		const auto dt_v = _mm256_set1_ps(dt);
+		const auto damping_v = _mm256_set1_ps(damping);
+		for (; i + simd::LANES <= end; i += simd::LANES)
+		{
+			const auto vx = _mm256_mul_ps(_mm256_loadu_ps(m_vx + i), damping_v);
+			const auto vy = _mm256_mul_ps(_mm256_loadu_ps(m_vy + i), damping_v);
+			_mm256_storeu_ps(m_vx + i, vx);
+			_mm256_storeu_ps(m_vy + i, vy);
+			_mm256_storeu_ps(m_x + i, _mm256_add_ps(_mm256_loadu_ps(m_x + i), _mm256_mul_ps(vx, dt_v)));
+			_mm256_storeu_ps(m_y + i, _mm256_add_ps(_mm256_loadu_ps(m_y + i), _mm256_mul_ps(vy, dt_v)));
+			_mm256_storeu_ps(m_age + i, _mm256_add_ps(_mm256_loadu_ps(m_age + i), dt_v));
+		}
+#elif defined(TD_SIMD_SSE)
+		const auto dt_v = _mm_set1_ps(dt);
+		const auto damping_v = _mm_set1_ps(damping);
+		for (; i + 4 <= end; i += 4)
+		{
+			const auto vx = _mm_mul_ps(_mm_loadu_ps(m_vx + i), damping_v);
+			const auto vy = _mm_mul_ps(_mm_loadu_ps(m_vy + i), damping_v);
+			_mm_storeu_ps(m_vx + i, vx);
+			_mm_storeu_ps(m_vy + i, vy);
+			_mm_storeu_ps(m_x + i, _mm_add_ps(_mm_loadu_ps(m_x + i), _mm_mul_ps(vx, dt_v)));
+			_mm_storeu_ps(m_y + i, _mm_add_ps(_mm_loadu_ps(m_y + i), _mm_mul_ps(vy, dt_v)));
+			_mm_storeu_ps(m_age + i, _mm_add_ps(_mm_loadu_ps(m_age + i), dt_v));
+		}
+#endif
+		for (; i < end; ++i)
+		{
+			m_vx[i] *= damping;
+			m_vy[i] *= damping;
+			m_x[i] += m_vx[i] * dt;
+			m_y[i] += m_vy[i] * dt;
+			m_age[i] += dt;
+		}
+	}
+
+	void particle_pool_t::write_instances(std::vector<sprite_instance_t>& instances, const blt::u32 texture) const
+	{
+		TD_PROFILE_ZONE("particle instances");
+		auto offset = instances.size();
+		instances.resize(offset + m_size);
+		for_each_span([&](const blt::size_t begin, const blt::size_t end) {
+			for (auto i = begin; i < end; ++i)
+			{
+				const auto alpha = 1 - m_age[i] / m_lifetime[i];
+				instances[offset] = sprite_instance_t{m_x[i], m_y[i], m_sprite_size[i] * alpha, texture, m_r[i], m_g[i], m_b[i], alpha};
+				// dead particles are overwritten by the next one
+				offset += alpha > 0;
+			}
+		});
+		instances.resize(offset);
+	}
+
+	particle_system_t::particle_system_t(const blt::size_t capacity, const blt::u64 seed): m_pool{capacity}, m_rng{seed}
+	{}
+
+	void particle_system_t::subscribe(event_bus_t& events)
+	{
+		events.subscribe<enemy_died_event_t, particle_system_t, &particle_system_t::on_died>(*this);
+		events.subscribe<projectile_hit_event_t, particle_system_t, &particle_system_t::on_hit>(*this);
+	}
+
+	void particle_system_t::emit(const particle_emitter_t& emitter, const blt::vec2& position)
+	{
+		for (blt::u32 i = 0; i < emitter.count; ++i)
+		{
+			const auto angle = m_rng.next_float(0, TWO_PI);
+			const auto speed = m_rng.next_float(emitter.min_speed, emitter.max_speed);
+			const auto lifetime = m_rng.next_float(emitter.min_lifetime, emitter.max_lifetime);
+			m_pool.spawn(position, blt::vec2{std::cos(angle) * speed, std::sin(angle) * speed}, lifetime, emitter.size, emitter.r, emitter.g,
+						emitter.b);
+		}
+	}
+
+	void particle_system_t::on_died(const enemy_died_event_t* events, const blt::size_t count)
+	{
+		for (blt::size_t i = 0; i < count; ++i)
+			emit(m_death_burst, blt::vec2{events[i].x, events[i].y});
+	}
+
+	void particle_system_t::on_hit(const projectile_hit_event_t* events, const blt::size_t count)
+	{
+		for (blt::size_t i = 0; i < count; ++i)
+			emit(m_hit_spark, blt::vec2{events[i].x, events[i].y});
+	}
+}
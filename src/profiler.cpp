@@ -0,0 +1,218 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <profiler.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace td::profiler
+{
+	namespace
+	{
+		struct zone_record_t
+		{
+			const char* name;
+			blt::u64 start_ns;
+			blt::u64 end_ns;
+		};
+
+		// the fields are relaxed atomics so a reader copying a slot its owner is overwriting gets a torn copy instead of a data race.
+		// read_record() spots that case and drops the copy.
+		struct zone_slot_t
+		{
+			std::atomic<const char*> name{nullptr};
+			std::atomic<blt::u64> start_ns{0};
+			std::atomic<blt::u64> end_ns{0};
+		};
+
+		// single producer ring. The owning thread writes a record then publishes it by bumping head, readers only look below head.
+		struct thread_buffer_t
+		{
+			std::array<zone_slot_t, ZONES_PER_THREAD> records{};
+			std::atomic<blt::u64> head{0};
+			blt::u32 thread_index = 0;
+			// first record end_frame() hasn't looked at yet, only touched by the end_frame() thread
+			blt::u64 read_head = 0;
+		};
+
+		struct zone_history_t
+		{
+			const char* name;
+			std::array<double, FRAME_HISTORY> frame_ms{};
+			double this_frame_ms = 0;
+		};
+
+		const auto epoch = std::chrono::steady_clock::now();
+
+		// buffers are never freed, a thread which exits leaves its zones behind for the trace
+		std::mutex buffers_mutex;
+		std::vector<std::unique_ptr<thread_buffer_t>> buffers;
+
+		std::vector<zone_history_t> histories;
+		std::vector<zone_stats_t> stats;
+		blt::u64 frame = 0;
+
+		thread_buffer_t& get_thread_buffer()
+		{
+			thread_local thread_buffer_t* buffer = [] {
+				std::scoped_lock lock{buffers_mutex};
+				auto& created = buffers.emplace_back(std::make_unique<thread_buffer_t>());
+				created->thread_index = static_cast<blt::u32>(buffers.size() - 1);
+				return created.get();
+			}();
+			return *buffer;
+		}
+
+		// the oldest record still in the ring
+		blt::u64 get_oldest(const blt::u64 head)
+		{
+			return head > ZONES_PER_THREAD ? head - ZONES_PER_THREAD : 0;
+		}
+
+		// copies record index out of the ring. Returns false if the owning thread has since started overwriting its slot, the copy may be torn then.
+		bool read_record(const thread_buffer_t& buffer, const blt::u64 index, zone_record_t& record)
+		{
+			const auto& slot = buffer.records[index % ZONES_PER_THREAD];
+			record.name = slot.name.load(std::memory_order_relaxed);
+			record.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+			record.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+			// pairs with the fence in record(): if any of the loads saw the next lap's stores, head is seen at that lap's record or later
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return buffer.head.load(std::memory_order_relaxed) < index + ZONES_PER_THREAD;
+		}
+
+		// names are compared by content, identical literals aren't guaranteed to share an address
+		bool same_name(const char* a, const char* b)
+		{
+			return a == b || std::strcmp(a, b) == 0;
+		}
+
+		void write_json_string(std::ofstream& out, const char* str)
+		{
+			out << '"';
+			for (; *str; ++str)
+			{
+				if (*str == '"' || *str == '\\')
+					out << '\\';
+				out << *str;
+			}
+			out << '"';
+		}
+	}
+
+	blt::u64 now_ns()
+	{
+		return static_cast<blt::u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+	}
+
+	void record(const char* name, const blt::u64 start_ns, const blt::u64 end_ns)
+	{
+		auto& buffer = get_thread_buffer();
+		const auto head = buffer.head.load(std::memory_order_relaxed);
+		auto& slot = buffer.records[head % ZONES_PER_THREAD];
+		// orders the publish of the previous record before the slot is overwritten, see read_record()
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.start_ns.store(start_ns, std::memory_order_relaxed);
+		slot.end_ns.store(end_ns, std::memory_order_relaxed);
+		buffer.head.store(head + 1, std::memory_order_release);
+	}
+
+	void end_frame()
+	{
+		{
+			std::scoped_lock lock{buffers_mutex};
+			for (const auto& buffer : buffers)
+			{
+				const auto head = buffer->head.load(std::memory_order_acquire);
+				for (auto i = std::max(buffer->read_head, get_oldest(head)); i < head; ++i)
+				{
+					zone_record_t zone{};
+					if (!read_record(*buffer, i, zone))
+						continue;
+					auto it = std::find_if(histories.begin(), histories.end(), [&zone](const zone_history_t& history) {
+						return same_name(history.name, zone.name);
+					});
+					if (it == histories.end())
+					{
+						histories.push_back(zone_history_t{zone.name});
+						it = histories.end() - 1;
+					}
+					it->this_frame_ms += static_cast<double>(zone.end_ns - zone.start_ns) / 1e6;
+				}
+				buffer->read_head = head;
+			}
+		}
+
+		const auto slot = frame % FRAME_HISTORY;
+		const auto frames = std::min<blt::u64>(frame + 1, FRAME_HISTORY);
+		++frame;
+		stats.resize(histories.size());
+		for (blt::size_t i = 0; i < histories.size(); ++i)
+		{
+			auto& history = histories[i];
+			history.frame_ms[slot] = history.this_frame_ms;
+			history.this_frame_ms = 0;
+			double total = 0, max = 0;
+			for (blt::size_t j = 0; j < frames; ++j)
+			{
+				total += history.frame_ms[j];
+				max = std::max(max, history.frame_ms[j]);
+			}
+			stats[i] = zone_stats_t{history.name, history.frame_ms[slot], total / static_cast<double>(frames), max};
+		}
+	}
+
+	const std::vector<zone_stats_t>& get_stats()
+	{
+		return stats;
+	}
+
+	bool write_chrome_trace(const std::string& path)
+	{
+		std::ofstream out{path, std::ios::trunc};
+		// microseconds with nanosecond precision, the default precision loses detail a few seconds in
+		out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+		bool first = true;
+		std::scoped_lock lock{buffers_mutex};
+		for (const auto& buffer : buffers)
+		{
+			const auto head = buffer->head.load(std::memory_order_acquire);
+			for (auto i = get_oldest(head); i < head; ++i)
+			{
+				zone_record_t zone{};
+				if (!read_record(*buffer, i, zone))
+					continue;
+				out << (first ? "\n" : ",\n") << "{\"name\":";
+				write_json_string(out, zone.name);
+				// complete events, timestamps in microseconds
+				out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_index << ",\"ts\":" << static_cast<double>(zone.start_ns) / 1e3
+					<< ",\"dur\":" << static_cast<double>(zone.end_ns - zone.start_ns) / 1e3 << '}';
+				first = false;
+			}
+		}
+		out << "\n]}\n";
+		return static_cast<bool>(out);
+	}
+}
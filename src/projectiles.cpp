@@ -0,0 +1,258 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <projectiles.h>
+#include <map.h>
+#include <profiler.h>
+#include <simd.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace td
+{
+	namespace
+	{
+		constexpr float COLLISION_CELL_SIZE = 16;
+		constexpr blt::u32 COLLISION_TABLE_BITS = 8;
+	}
+
+	projectile_pool_t::projectile_pool_t(const blt::size_t capacity): m_capacity{capacity}, m_enemy_grid{COLLISION_CELL_SIZE, COLLISION_TABLE_BITS}
+	{
+		pool_layout_t layout;
+		const auto x = layout.add<float>(capacity);
+		const auto y = layout.add<float>(capacity);
+		const auto vx = layout.add<float>(capacity);
+		const auto vy = layout.add<float>(capacity);
+		const auto lifetime = layout.add<float>(capacity);
+		const auto damage = layout.add<float>(capacity);
+		const auto radius = layout.add<float>(capacity);
+		const auto damage_mask = layout.add<blt::u8>(capacity);
+		m_block = pool_block_t{layout};
+		m_x = m_block.get<float>(x);
+		m_y = m_block.get<float>(y);
+		m_vx = m_block.get<float>(vx);
+		m_vy = m_block.get<float>(vy);
+		m_lifetime = m_block.get<float>(lifetime);
+		m_damage = m_block.get<float>(damage);
+		m_radius = m_block.get<float>(radius);
+		m_damage_mask = m_block.get<blt::u8>(damage_mask);
+	}
+
+	bool projectile_pool_t::spawn(const projectile_t& projectile)
+	{
+		if (m_size == m_capacity)
+			return false;
+		const auto i = m_size++;
+		m_x[i] = projectile.position.x();
+		m_y[i] = projectile.position.y();
+		m_vx[i] = projectile.velocity.x();
+		m_vy[i] = projectile.velocity.y();
+		m_lifetime[i] = projectile.lifetime;
+		m_damage[i] = projectile.damage;
+		m_radius[i] = projectile.radius;
+		m_damage_mask[i] = projectile.damage_mask;
+		return true;
+	}
+
+	void projectile_pool_t::step(const float dt, const map_t& map, std::vector<hit_t>& hits, event_bus_t* events)
+	{
+		TD_PROFILE_ZONE("projectile step");
+		m_expired.clear();
+		m_collided.clear();
+		integrate(dt);
+		collide(dt, map, hits, events);
+
+		// a projectile can expire and hit in the same step, it is only removed once
+		m_removed.clear();
+		std::set_union(m_expired.begin(), m_expired.end(), m_collided.begin(), m_collided.end(), std::back_inserter(m_removed));
+		// from the back, so the projectile moved into a freed slot is never one still waiting to be removed
+		for (auto it = m_removed.rbegin(); it != m_removed.rend(); ++it)
+			remove(*it);
+	}
+
+	void projectile_pool_t::integrate(const float dt)
+	{
+		TD_PROFILE_ZONE("projectile integrate");
+		const auto count = static_cast<blt::u32>(m_size);
+		blt::u32 i = 0;
+#if defined(TD_SIMD_AVX)
+		const auto dt_v = _mm256_set1_ps(dt);
+		const auto zero_v = _mm256_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			_mm256_storeu_ps(m_x + i, _mm256_add_ps(_mm256_loadu_ps(m_x + i), _mm256_mul_ps(_mm256_loadu_ps(m_vx + i), dt_v)));
+			_mm256_storeu_ps(m_y + i, _mm256_add_ps(_mm256_loadu_ps(m_y + i), _mm256_mul_ps(_mm256_loadu_ps(m_vy + i), dt_v)));
+			const auto lifetime = _mm256_sub_ps(_mm256_loadu_ps(m_lifetime + i), dt_v);
+			_mm256_storeu_ps(m_lifetime + i, lifetime);
+			simd::append_mask_indices(_mm256_movemask_ps(_mm256_cmp_ps(lifetime, zero_v, _CMP_LE_OQ)), i, m_expired);
+		}
+#elif defined(TD_SIMD_SSE)
+		const auto dt_v = _mm_set1_ps(dt);
+		const auto zero_v = _mm_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			int mask = 0;
+			for (blt::u32 half = 0; half < simd::LANES; half += 4)
+			{
+				const auto j = i + half;
+				_mm_storeu_ps(m_x + j, _mm_add_ps(_mm_loadu_ps(m_x + j), _mm_mul_ps(_mm_loadu_ps(m_vx + j), dt_v)));
+				_mm_storeu_ps(m_y + j, _mm_add_ps(_mm_loadu_ps(m_y + j), _mm_mul_ps(_mm_loadu_ps(m_vy + j), dt_v)));
+				const auto lifetime = _mm_sub_ps(_mm_loadu_ps(m_lifetime + j), dt_v);
+				_mm_storeu_ps(m_lifetime + j, lifetime);
+				mask |= _mm_movemask_ps(_mm_cmple_ps(lifetime, zero_v)) << half;
+			}
+			simd::append_mask_indices(mask, i, m_expired);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			m_x[i] += m_vx[i] * dt;
+			m_y[i] += m_vy[i] * dt;
+			m_lifetime[i] -= dt;
+			if (m_lifetime[i] <= 0)
+				m_expired.push_back(i);
+		}
+	}
+
+	void projectile_pool_t::collide(const float dt, const map_t& map, std::vector<hit_t>& hits, event_bus_t* events)
+	{
+		TD_PROFILE_ZONE("projectile collide");
+		const auto& positions = map.get_enemy_positions();
+		if (m_size == 0 || positions.empty())
+			return;
+		m_enemy_grid.rebuild(positions);
+		const auto& grid = m_enemy_grid;
+		const auto& enemies = map.get_enemies();
+		for (blt::u32 i = 0; i < m_size; ++i)
+		{
+			// the projectile swept from start to end this step, an enemy is hit if their circles touched anywhere along the way
+			const auto end_x = m_x[i];
+			const auto end_y = m_y[i];
+			const auto dx = m_vx[i] * dt;
+			const auto dy = m_vy[i] * dt;
+			const auto start_x = end_x - dx;
+			const auto start_y = end_y - dy;
+			const auto reach = m_radius[i] + ENEMY_RADIUS;
+			const auto reach_squared = reach * reach;
+			const auto a = dx * dx + dy * dy;
+
+			// earliest time of contact along the sweep, in [0, 1]
+			auto target = enemy_store_t::INVALID_INDEX;
+			float target_time = 2;
+			const bounding_box_t box{blt::vec2{std::min(start_x, end_x) - reach, std::min(start_y, end_y) - reach},
+									blt::vec2{std::max(start_x, end_x) + reach, std::max(start_y, end_y) + reach}};
+			grid.for_each_in_box(box, [&](const blt::u32 enemy) {
+				const auto fx = start_x - positions[enemy].x();
+				const auto fy = start_y - positions[enemy].y();
+				const auto c = fx * fx + fy * fy - reach_squared;
+				float time;
+				if (c <= 0)
+					time = 0;
+				else
+				{
+					// solve |f + d * t| = reach for the first t
+					if (a <= 0)
+						return;
+					const auto b = fx * dx + fy * dy;
+					const auto discriminant = b * b - a * c;
+					if (b >= 0 || discriminant < 0)
+						return;
+					time = (-b - std::sqrt(discriminant)) / a;
+					if (time > 1)
+						return;
+				}
+				if (time < target_time || (time == target_time && enemy < target))
+				{
+					target = enemy;
+					target_time = time;
+				}
+			});
+			if (target == enemy_store_t::INVALID_INDEX)
+				continue;
+			const auto handle = enemies.get_handle(target);
+			hits.push_back(hit_t{handle, m_damage[i], m_damage_mask[i]});
+			m_collided.push_back(i);
+			// where the circles first touched rather than where the projectile ended up
+			if (events)
+				events->push(projectile_hit_event_t{start_x + dx * target_time, start_y + dy * target_time, handle});
+		}
+	}
+
+	void projectile_pool_t::remove(const blt::size_t index)
+	{
+		const auto last = --m_size;
+		m_x[index] = m_x[last];
+		m_y[index] = m_y[last];
+		m_vx[index] = m_vx[last];
+		m_vy[index] = m_vy[last];
+		m_lifetime[index] = m_lifetime[last];
+		m_damage[index] = m_damage[last];
+		m_radius[index] = m_radius[last];
+		m_damage_mask[index] = m_damage_mask[last];
+	}
+
+	template <typename Func>
+	void projectile_pool_t::for_each_array(Func&& func) const
+	{
+		func(m_x, sizeof(float));
+		func(m_y, sizeof(float));
+		func(m_vx, sizeof(float));
+		func(m_vy, sizeof(float));
+		func(m_lifetime, sizeof(float));
+		func(m_damage, sizeof(float));
+		func(m_radius, sizeof(float));
+		func(m_damage_mask, sizeof(blt::u8));
+	}
+
+	void projectile_pool_t::write_instances(std::vector<sprite_instance_t>& instances) const
+	{
+		constexpr float size = 4;
+		const auto offset = instances.size();
+		instances.resize(offset + m_size);
+		for (blt::size_t i = 0; i < m_size; ++i)
+			instances[offset + i] = sprite_instance_t{m_x[i], m_y[i], size, NO_TEXTURE, 1, 1, 0, 1};
+	}
+
+	void projectile_pool_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		writer.write(static_cast<blt::u64>(m_size));
+		for_each_array([this, &writer](const void* data, const blt::size_t element_size) {
+			writer.write_bytes(data, m_size * element_size);
+		});
+	}
+
+	bool projectile_pool_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		blt::u64 size = 0;
+		if (!reader.read(size) || size > m_capacity)
+			return false;
+		m_size = size;
+		for_each_array([this, &reader](void* data, const blt::size_t element_size) {
+			reader.read_bytes(data, m_size * element_size);
+		});
+		return reader.good();
+	}
+
+	void projectile_pool_t::add_to_hash(fnv1a_t& hash) const
+	{
+		hash.add(static_cast<blt::u64>(m_size));
+		for_each_array([this, &hash](const void* data, const blt::size_t element_size) {
+			hash.add_bytes(data, m_size * element_size);
+		});
+	}
+}
@@ -0,0 +1,137 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <replay.h>
+#include <game.h>
+#include <algorithm>
+#include <fstream>
+
+namespace td
+{
+	namespace
+	{
+		struct replay_header_t
+		{
+			blt::u32 magic;
+			blt::u32 version;
+			blt::u64 seed;
+			blt::u64 database_hash;
+			float tick_length;
+			blt::u32 hash_interval;
+			blt::u64 input_count;
+			blt::u64 checkpoint_count;
+			// widened so the header has no padding, a float survives the round trip through double exactly
+			double speed_multiplier;
+		};
+
+		// inputs are read straight from disk, anything the game would use as an index has to be checked before it is trusted
+		bool is_valid(const input_t& input)
+		{
+			switch (input.type)
+			{
+				case input_type_t::START_WAVE:
+					return static_cast<blt::u32>(input.wave.enemy) < ENEMY_ID_COUNT;
+				case input_type_t::PLACE_TOWER:
+					return static_cast<blt::u32>(input.tower.type) < TOWER_ID_COUNT;
+			}
+			return false;
+		}
+	}
+
+	bool replay_t::write(const std::string& path) const
+	{
+		std::ofstream file{path, std::ios::binary | std::ios::trunc};
+		const replay_header_t header{MAGIC, VERSION, seed, database_hash, tick_length, hash_interval, inputs.size(), checkpoints.size(),
+									static_cast<double>(speed_multiplier)};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(inputs.data()), static_cast<std::streamsize>(inputs.size() * sizeof(input_t)));
+		file.write(reinterpret_cast<const char*>(checkpoints.data()),
+					static_cast<std::streamsize>(checkpoints.size() * sizeof(replay_checkpoint_t)));
+		return static_cast<bool>(file);
+	}
+
+	bool replay_t::read(const std::string& path)
+	{
+		std::ifstream file{path, std::ios::binary | std::ios::ate};
+		if (!file)
+			return false;
+		const auto size = static_cast<blt::u64>(file.tellg());
+		file.seekg(0);
+		replay_header_t header{};
+		if (size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+		if (header.magic != MAGIC || header.version != VERSION)
+			return false;
+		// checked against the file size first so a corrupt count can't ask for an enormous allocation
+		if (header.input_count > size / sizeof(input_t) || header.checkpoint_count > size / sizeof(replay_checkpoint_t) ||
+			sizeof(header) + header.input_count * sizeof(input_t) + header.checkpoint_count * sizeof(replay_checkpoint_t) != size)
+			return false;
+		std::vector<input_t> read_inputs(header.input_count);
+		std::vector<replay_checkpoint_t> read_checkpoints(header.checkpoint_count);
+		file.read(reinterpret_cast<char*>(read_inputs.data()), static_cast<std::streamsize>(read_inputs.size() * sizeof(input_t)));
+		file.read(reinterpret_cast<char*>(read_checkpoints.data()),
+				static_cast<std::streamsize>(read_checkpoints.size() * sizeof(replay_checkpoint_t)));
+		if (!file || !std::all_of(read_inputs.begin(), read_inputs.end(), is_valid))
+			return false;
+		seed = header.seed;
+		database_hash = header.database_hash;
+		speed_multiplier = static_cast<float>(header.speed_multiplier);
+		tick_length = header.tick_length;
+		hash_interval = header.hash_interval;
+		inputs = std::move(read_inputs);
+		checkpoints = std::move(read_checkpoints);
+		return true;
+	}
+
+	replay_result_t play_replay(const replay_t& replay, const std::vector<path_segment_t>& path_segments, job_system_t* jobs)
+	{
+		game_t game{path_segments, replay.tick_length, replay.seed};
+		game.get_map().set_job_system(jobs);
+		game.get_map().set_speed_multiplier(replay.speed_multiplier);
+
+		replay_result_t result;
+		if (replay.database_hash != game.get_database().compute_hash())
+		{
+			result.database_matched = false;
+			return result;
+		}
+
+		blt::u64 end_tick = replay.checkpoints.empty() ? 0 : replay.checkpoints.back().tick;
+		if (!replay.inputs.empty())
+			end_tick = std::max(end_tick, replay.inputs.back().tick + 1);
+
+		blt::size_t next_input = 0;
+		blt::size_t next_checkpoint = 0;
+		while (game.get_tick() < end_tick)
+		{
+			while (next_input < replay.inputs.size() && replay.inputs[next_input].tick == game.get_tick())
+				game.queue_input(replay.inputs[next_input++]);
+			game.step(replay.tick_length);
+			if (next_checkpoint < replay.checkpoints.size() && replay.checkpoints[next_checkpoint].tick == game.get_tick())
+			{
+				if (replay.checkpoints[next_checkpoint].hash != game.compute_state_hash())
+				{
+					result.mismatch_tick = game.get_tick();
+					break;
+				}
+				++next_checkpoint;
+			}
+		}
+		result.ticks = game.get_tick();
+		return result;
+	}
+}
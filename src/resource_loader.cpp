@@ -0,0 +1,158 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <resource_loader.h>
+#include <profiler.h>
+#include <algorithm>
+#include <chrono>
+
+namespace td
+{
+	resource_loader_t::resource_loader_t(const decode_func_t decode, const upload_func_t upload, void* context, const blt::size_t thread_count):
+		m_decode{decode}, m_upload{upload}, m_context{context}, m_thread_count{thread_count}
+	{}
+
+	resource_loader_t::~resource_loader_t()
+	{
+		// nothing left to claim, the threads finish the image they are on and exit
+		m_next.store(m_requests.size());
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	void resource_loader_t::enqueue(std::string path, std::string name, const resource_priority_t priority)
+	{
+		m_requests.push_back(request_t{std::move(path), std::move(name), priority});
+		if (priority == resource_priority_t::CRITICAL)
+			++m_critical_count;
+	}
+
+	void resource_loader_t::start()
+	{
+		if (m_started)
+			return;
+		m_started = true;
+		// requests are claimed in order, so critical ones are decoded before anything streamed
+		std::stable_partition(m_requests.begin(), m_requests.end(), [](const request_t& request) {
+			return request.priority == resource_priority_t::CRITICAL;
+		});
+		const auto thread_count = std::min(m_thread_count, m_requests.size());
+		for (blt::size_t i = 0; i < thread_count; ++i)
+			m_threads.emplace_back(&resource_loader_t::worker_main, this);
+	}
+
+	void resource_loader_t::worker_main()
+	{
+		while (decode_next())
+		{}
+	}
+
+	bool resource_loader_t::decode_next()
+	{
+		const auto index = m_next.fetch_add(1);
+		if (index >= m_requests.size())
+			return false;
+		decoded_t decoded{static_cast<blt::u32>(index), false, {}};
+		{
+			TD_PROFILE_ZONE("resource decode");
+			decoded.ok = m_decode(m_context, m_requests[index].path, decoded.image);
+		}
+		{
+			std::scoped_lock lock{m_mutex};
+			m_decoded.push_back(std::move(decoded));
+		}
+		m_decoded_count.fetch_add(1, std::memory_order_relaxed);
+		m_decoded_cv.notify_one();
+		return true;
+	}
+
+	bool resource_loader_t::upload_next()
+	{
+		if (m_upload_index == m_uploading.size())
+		{
+			// the finished list is swapped out whole, the decode threads only ever wait for the length of a swap
+			m_uploading.clear();
+			m_upload_index = 0;
+			if (m_thread_count == 0)
+				decode_next();
+			std::scoped_lock lock{m_mutex};
+			std::swap(m_decoded, m_uploading);
+		}
+		if (m_upload_index == m_uploading.size())
+			return false;
+		auto& decoded = m_uploading[m_upload_index++];
+		const auto& request = m_requests[decoded.request];
+		if (decoded.ok)
+		{
+			TD_PROFILE_ZONE("resource upload");
+			m_upload(m_context, request.name, decoded.image);
+		} else
+			m_failures.push_back(request.path);
+		// the pixels aren't needed once they are on the GPU
+		decoded.image = image_t{};
+		++m_uploaded;
+		if (request.priority == resource_priority_t::CRITICAL)
+			++m_critical_uploaded;
+		return true;
+	}
+
+	void resource_loader_t::wait_for_decode()
+	{
+		// without threads upload_next() decodes by itself
+		if (m_thread_count == 0)
+			return;
+		std::unique_lock lock{m_mutex};
+		m_decoded_cv.wait(lock, [this]() {
+			return !m_decoded.empty();
+		});
+	}
+
+	blt::size_t resource_loader_t::upload(const blt::u64 budget_ns)
+	{
+		start();
+		const auto begin = std::chrono::steady_clock::now();
+		blt::size_t count = 0;
+		while (upload_next())
+		{
+			++count;
+			const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+			if (static_cast<blt::u64>(elapsed) >= budget_ns)
+				break;
+		}
+		return count;
+	}
+
+	void resource_loader_t::finish_critical()
+	{
+		start();
+		while (!is_critical_done())
+		{
+			if (!upload_next())
+				wait_for_decode();
+		}
+	}
+
+	void resource_loader_t::finish()
+	{
+		start();
+		while (!is_done())
+		{
+			if (!upload_next())
+				wait_for_decode();
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <spatial_grid.h>
+
+namespace td
+{
+	spatial_grid_t::spatial_grid_t(const float cell_size, const blt::u32 table_bits): m_cell_size{cell_size}, m_inv_cell_size{1.0f / cell_size},
+																					m_table_bits{table_bits}, m_axis_mask{(1u << table_bits) - 1}
+	{
+		m_bucket_start.resize((static_cast<blt::size_t>(1) << (table_bits * 2)) + 1);
+	}
+
+	void spatial_grid_t::rebuild(const blt::vec2* positions, const blt::size_t count)
+	{
+		// counting sort by bucket: count, prefix sum, scatter
+		std::fill(m_bucket_start.begin(), m_bucket_start.end(), 0);
+		m_buckets.resize(count);
+		for (blt::size_t i = 0; i < count; ++i)
+		{
+			const auto bucket = bucket_of(cell_of(positions[i].x()), cell_of(positions[i].y()));
+			m_buckets[i] = bucket;
+			++m_bucket_start[bucket + 1];
+		}
+		for (blt::size_t i = 1; i < m_bucket_start.size(); ++i)
+			m_bucket_start[i] += m_bucket_start[i - 1];
+
+		m_entries.resize(count);
+		m_x.resize(count);
+		m_y.resize(count);
+		// scatter using the start of each bucket as a write cursor, then shift the cursors back into starts
+		for (blt::size_t i = 0; i < count; ++i)
+		{
+			const auto slot = m_bucket_start[m_buckets[i]]++;
+			m_entries[slot] = static_cast<blt::u32>(i);
+			m_x[slot] = positions[i].x();
+			m_y[slot] = positions[i].y();
+		}
+		for (blt::size_t i = m_bucket_start.size() - 1; i > 0; --i)
+			m_bucket_start[i] = m_bucket_start[i - 1];
+		m_bucket_start[0] = 0;
+	}
+}
@@ -0,0 +1,257 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <sprite_renderer.h>
+#include <blt/gfx/gl_includes.h>
+#include <blt/logging/logging.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace td
+{
+	namespace
+	{
+#ifdef __EMSCRIPTEN__
+#define TD_SPRITE_SHADER_VERSION "#version 300 es\nprecision mediump float;\nprecision mediump sampler2DArray;\n"
+#else
+#define TD_SPRITE_SHADER_VERSION "#version 330 core\n"
+#endif
+
+		const char* sprite_vertex_shader = TD_SPRITE_SHADER_VERSION R"(
+layout (location = 0) in vec2 corner;
+layout (location = 1) in vec2 position;
+layout (location = 2) in float size;
+layout (location = 3) in vec4 color;
+layout (location = 4) in uint texture_layer;
+
+// the block blt's own shaders read, filled by matrix_state_manager. Only the leading members are declared, the layout is std140
+// so their offsets match the full block.
+layout (std140) uniform GlobalMatrices
+{
+	mat4 projection;
+	mat4 ortho;
+	mat4 view;
+};
+
+out vec4 sprite_color;
+out vec2 sprite_uv;
+flat out uint sprite_layer;
+
+void main()
+{
+	// same transform batch_renderer_2d uses, so sprites stay on the path when the camera moves
+	vec2 pixel = position + corner * size;
+	gl_Position = ortho * view * vec4(pixel, 0.0, 1.0);
+	sprite_color = color;
+	// image rows run top to bottom, as does pixel space
+	sprite_uv = corner + 0.5;
+	sprite_layer = texture_layer;
+}
+)";
+
+		const char* sprite_fragment_shader = TD_SPRITE_SHADER_VERSION R"(
+in vec4 sprite_color;
+in vec2 sprite_uv;
+flat in uint sprite_layer;
+
+uniform sampler2DArray sprite_textures;
+
+out vec4 frag_color;
+
+void main()
+{
+	// NO_TEXTURE, or any index past the array, is an untextured sprite
+	vec4 texel = vec4(1.0);
+	if (sprite_layer < uint(textureSize(sprite_textures, 0).z))
+		texel = texture(sprite_textures, vec3(sprite_uv, float(sprite_layer)));
+	frag_color = texel * sprite_color;
+}
+)";
+
+		// binding point matrix_state_manager attaches its uniform buffer to
+		constexpr GLuint GLOBAL_MATRICES_BINDING = 0;
+
+		GLuint compile_shader(const GLenum type, const char* source)
+		{
+			const auto shader = glCreateShader(type);
+			glShaderSource(shader, 1, &source, nullptr);
+			glCompileShader(shader);
+			GLint status = 0;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+			if (!status)
+			{
+				char log[1024];
+				glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+				BLT_ERROR("Failed to compile sprite shader: {}", log);
+			}
+			return shader;
+		}
+
+		// nearest neighbour resample of image into a TEXTURE_SIZE square of rgba pixels
+		void resample_to_layer(const image_t& image, std::vector<blt::u8>& pixels)
+		{
+			constexpr auto size = sprite_renderer_t::TEXTURE_SIZE;
+			pixels.resize(static_cast<blt::size_t>(size) * size * 4);
+			for (blt::u32 y = 0; y < size; ++y)
+			{
+				const auto source_y = static_cast<blt::size_t>(y) * image.height / size;
+				for (blt::u32 x = 0; x < size; ++x)
+				{
+					const auto source_x = static_cast<blt::size_t>(x) * image.width / size;
+					const auto* source = image.pixels.data() + (source_y * image.width + source_x) * image.channels;
+					auto* target = pixels.data() + (static_cast<blt::size_t>(y) * size + x) * 4;
+					switch (image.channels)
+					{
+						case 1:
+							target[0] = target[1] = target[2] = source[0];
+							target[3] = 255;
+							break;
+						case 2:
+							target[0] = target[1] = target[2] = source[0];
+							target[3] = source[1];
+							break;
+						case 3:
+							std::copy_n(source, 3, target);
+							target[3] = 255;
+							break;
+						default:
+							std::copy_n(source, 4, target);
+							break;
+					}
+				}
+			}
+		}
+	}
+
+	void sprite_renderer_t::create()
+	{
+		const auto vertex = compile_shader(GL_VERTEX_SHADER, sprite_vertex_shader);
+		const auto fragment = compile_shader(GL_FRAGMENT_SHADER, sprite_fragment_shader);
+		m_program = glCreateProgram();
+		glAttachShader(m_program, vertex);
+		glAttachShader(m_program, fragment);
+		glLinkProgram(m_program);
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		const auto matrices = glGetUniformBlockIndex(m_program, "GlobalMatrices");
+		if (matrices != GL_INVALID_INDEX)
+			glUniformBlockBinding(m_program, matrices, GLOBAL_MATRICES_BINDING);
+		glUseProgram(m_program);
+		glUniform1i(glGetUniformLocation(m_program, "sprite_textures"), 0);
+		glUseProgram(0);
+
+		// white layers until set_texture replaces them, so a sprite whose texture hasn't streamed in yet shows its colour
+		GLuint texture_array = 0;
+		glGenTextures(1, &texture_array);
+		m_texture_array = texture_array;
+		const std::vector<blt::u8> white(static_cast<blt::size_t>(TEXTURE_SIZE) * TEXTURE_SIZE * MAX_TEXTURES * 4, 255);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_array);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, MAX_TEXTURES, 0, GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		// unit quad around the sprite center, drawn as a triangle strip
+		constexpr float corners[] = {-0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+
+		GLuint vao = 0;
+		GLuint buffers[2] = {0, 0};
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(2, buffers);
+		m_vao = vao;
+		m_quad_vbo = buffers[0];
+		m_instance_vbo = buffers[1];
+
+		glBindVertexArray(m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+		constexpr auto stride = static_cast<GLsizei>(sizeof(sprite_instance_t));
+		const auto attribute = [](const GLuint index, const GLint components, const std::size_t offset) {
+			glEnableVertexAttribArray(index);
+			glVertexAttribPointer(index, components, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+			glVertexAttribDivisor(index, 1);
+		};
+		attribute(1, 2, offsetof(sprite_instance_t, x));
+		attribute(2, 1, offsetof(sprite_instance_t, size));
+		attribute(3, 4, offsetof(sprite_instance_t, r));
+		glEnableVertexAttribArray(4);
+		glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<const void*>(offsetof(sprite_instance_t, texture)));
+		glVertexAttribDivisor(4, 1);
+		glBindVertexArray(0);
+	}
+
+	bool sprite_renderer_t::set_texture(const blt::u32 layer, const image_t& image)
+	{
+		if (m_texture_array == 0 || layer >= MAX_TEXTURES || image.width == 0 || image.height == 0 || image.channels == 0 || image.channels > 4 ||
+			image.pixels.size() < static_cast<blt::size_t>(image.width) * image.height * image.channels)
+			return false;
+		resample_to_layer(image, m_layer_pixels);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_array);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer), TEXTURE_SIZE, TEXTURE_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+						m_layer_pixels.data());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return true;
+	}
+
+	void sprite_renderer_t::render(const std::vector<sprite_instance_t>& instances)
+	{
+		if (instances.empty() || m_program == 0)
+			return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+		const auto bytes = static_cast<GLsizeiptr>(instances.size() * sizeof(sprite_instance_t));
+		// grow geometrically so a growing wave doesn't reallocate the buffer every frame
+		if (instances.size() > m_capacity)
+			m_capacity = std::max(instances.size(), m_capacity * 2);
+		// respecifying the storage every frame orphans last frame's buffer, so the driver doesn't stall on it
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity * sizeof(sprite_instance_t)), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+
+		glUseProgram(m_program);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_array);
+		glBindVertexArray(m_vao);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+		glBindVertexArray(0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glUseProgram(0);
+	}
+
+	void sprite_renderer_t::cleanup()
+	{
+		if (m_program == 0)
+			return;
+		const GLuint vao = m_vao;
+		const GLuint buffers[2] = {m_quad_vbo, m_instance_vbo};
+		glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(2, buffers);
+		const GLuint texture_array = m_texture_array;
+		glDeleteTextures(1, &texture_array);
+		glDeleteProgram(m_program);
+		m_program = 0;
+		m_texture_array = 0;
+		m_capacity = 0;
+	}
+}
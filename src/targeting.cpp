@@ -0,0 +1,71 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <targeting.h>
+#include <iterator>
+
+namespace td
+{
+	namespace
+	{
+		constexpr std::string_view targeting_names[] = {"FIRST", "LAST", "STRONGEST", "CLOSEST"};
+		// spacing of the path samples tested against a tower's range
+		constexpr float COVERAGE_STEP = 4;
+	}
+
+	bool parse_targeting(const std::string_view name, targeting_t& targeting)
+	{
+		const auto it = std::find(std::begin(targeting_names), std::end(targeting_names), name);
+		if (it == std::end(targeting_names))
+			return false;
+		targeting = static_cast<targeting_t>(it - std::begin(targeting_names));
+		return true;
+	}
+
+	void find_path_coverage(const map_t& map, const blt::vec2& center, const float range, std::vector<path_interval_t>& intervals)
+	{
+		// a point on the path moves at most as far as the distance along it changes, so every point in range is within half a step of a
+		// sample within range + half a step. Padding the sampled stretches by half a step then covers everything in range.
+		const auto half_step = COVERAGE_STEP * 0.5f;
+		const auto padded_range = range + half_step;
+		const auto padded_squared = padded_range * padded_range;
+		const auto total_length = map.get_total_length();
+		const auto samples = static_cast<blt::size_t>(total_length / COVERAGE_STEP) + 1;
+		const auto first = intervals.size();
+		for (blt::size_t i = 0; i <= samples; ++i)
+		{
+			const auto distance = std::min(static_cast<float>(i) * COVERAGE_STEP, total_length);
+			const auto point = map.get_point(distance);
+			const auto dx = point.x() - center.x();
+			const auto dy = point.y() - center.y();
+			if (dx * dx + dy * dy > padded_squared)
+				continue;
+			const auto min_distance = distance - half_step;
+			const auto max_distance = distance + half_step;
+			if (intervals.size() > first && intervals.back().max_distance >= min_distance)
+				intervals.back().max_distance = max_distance;
+			else
+				intervals.push_back(path_interval_t{min_distance, max_distance});
+		}
+	}
+
+	targeting_view_t make_targeting_view(map_t& map)
+	{
+		const auto& sorted = map.get_sorted_view();
+		return targeting_view_t{sorted.data(), sorted.size(), map.get_enemy_positions().data(), map.get_enemies().get_health_left().data()};
+	}
+}
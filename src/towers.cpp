@@ -16,6 +16,246 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <towers.h>
+#include <simd.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 
 namespace td
-{}
+{
+	namespace
+	{
+		constexpr std::string_view tower_names[] = {"BASIC", "SNIPER", "LOVE"};
+		static_assert(std::size(tower_names) == TOWER_ID_COUNT, "every tower_id_t needs a name");
+		constexpr float PROJECTILE_RADIUS = 3;
+		// projectile lifetime, as a multiple of the time needed to cross the tower's range
+		constexpr float PROJECTILE_RANGE_SLACK = 1.5f;
+	}
+
+	bool parse_tower_id(const std::string_view name, tower_id_t& id)
+	{
+		const auto it = std::find(std::begin(tower_names), std::end(tower_names), name);
+		if (it == std::end(tower_names))
+			return false;
+		id = static_cast<tower_id_t>(it - std::begin(tower_names));
+		return true;
+	}
+
+	blt::u32 tower_archetype_t::add(const blt::u32 id, const blt::vec2& position)
+	{
+		m_ids.push_back(id);
+		m_x.push_back(position.x());
+		m_y.push_back(position.y());
+		m_range_squared.push_back(m_stats.range * m_stats.range);
+		m_cooldown.push_back(0);
+		m_damage.push_back(m_stats.damage);
+		m_damage_mask.push_back(m_stats.damage_mask);
+		return static_cast<blt::u32>(m_ids.size() - 1);
+	}
+
+	void tower_archetype_t::tick_cooldowns(const float dt, std::vector<blt::u32>& ready)
+	{
+		const auto count = static_cast<blt::u32>(m_cooldown.size());
+		float* cooldown = m_cooldown.data();
+		blt::u32 i = 0;
+#if defined(TD_SIMD_AVX)
+		const auto dt_v = _mm256_set1_ps(dt);
+		const auto zero_v = _mm256_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			const auto c = _mm256_sub_ps(_mm256_loadu_ps(cooldown + i), dt_v);
+			_mm256_storeu_ps(cooldown + i, c);
+			simd::append_mask_indices(_mm256_movemask_ps(_mm256_cmp_ps(c, zero_v, _CMP_LE_OQ)), i, ready);
+		}
+#elif defined(TD_SIMD_SSE)
+		const auto dt_v = _mm_set1_ps(dt);
+		const auto zero_v = _mm_setzero_ps();
+		for (; i + simd::LANES <= count; i += simd::LANES)
+		{
+			const auto c_lo = _mm_sub_ps(_mm_loadu_ps(cooldown + i), dt_v);
+			const auto c_hi = _mm_sub_ps(_mm_loadu_ps(cooldown + i + 4), dt_v);
+			_mm_storeu_ps(cooldown + i, c_lo);
+			_mm_storeu_ps(cooldown + i + 4, c_hi);
+			const int mask = _mm_movemask_ps(_mm_cmple_ps(c_lo, zero_v)) | (_mm_movemask_ps(_mm_cmple_ps(c_hi, zero_v)) << 4);
+			simd::append_mask_indices(mask, i, ready);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			cooldown[i] -= dt;
+			if (cooldown[i] <= 0)
+				ready.push_back(i);
+		}
+	}
+
+	void tower_archetype_t::update_coverage(const map_t& map)
+	{
+		for (auto i = static_cast<blt::u32>(m_coverage_first.size()); i < m_ids.size(); ++i)
+		{
+			const auto first = static_cast<blt::u32>(m_coverage.size());
+			find_path_coverage(map, blt::vec2{m_x[i], m_y[i]}, std::sqrt(m_range_squared[i]), m_coverage);
+			m_coverage_first.push_back(first);
+			m_coverage_count.push_back(static_cast<blt::u32>(m_coverage.size()) - first);
+		}
+	}
+
+	void tower_archetype_t::fire(const std::vector<blt::u32>& ready, map_t& map, std::vector<hit_t>& hits, projectile_pool_t& projectiles,
+								 event_bus_t* events)
+	{
+		update_coverage(map);
+		const auto view = make_targeting_view(map);
+		// one dispatch per archetype, the per tower loop is specialised for the policy
+		switch (m_stats.targeting)
+		{
+			case targeting_t::FIRST:
+				fire<target_first_t>(ready, view, map.get_enemies(), hits, projectiles, events);
+				break;
+			case targeting_t::LAST:
+				fire<target_last_t>(ready, view, map.get_enemies(), hits, projectiles, events);
+				break;
+			case targeting_t::STRONGEST:
+				fire<target_strongest_t>(ready, view, map.get_enemies(), hits, projectiles, events);
+				break;
+			case targeting_t::CLOSEST:
+				fire<target_closest_t>(ready, view, map.get_enemies(), hits, projectiles, events);
+				break;
+		}
+	}
+
+	template <typename Policy>
+	void tower_archetype_t::fire(const std::vector<blt::u32>& ready, const targeting_view_t& view, const enemy_store_t& enemies,
+								 std::vector<hit_t>& hits, projectile_pool_t& projectiles, event_bus_t* events)
+	{
+		for (const auto i : ready)
+		{
+			const auto target = find_target<Policy>(view, target_query_t{blt::vec2{m_x[i], m_y[i]}, m_range_squared[i],
+																		m_coverage.data() + m_coverage_first[i], m_coverage_count[i]});
+			if (target == enemy_store_t::INVALID_INDEX)
+			{
+				// hold fire without letting the cooldown run further negative, the tower fires the moment something walks in
+				m_cooldown[i] = 0;
+				continue;
+			}
+			// adding the interval rather than setting it keeps the rate of fire exact when a tick overshoots the cooldown
+			m_cooldown[i] += m_stats.fire_interval;
+			const auto handle = enemies.get_handle(target);
+			if (!launch(i, view.positions[target], projectiles))
+				hits.push_back(hit_t{handle, m_damage[i], m_damage_mask[i]});
+			if (events)
+				events->push(tower_fired_event_t{m_ids[i], m_x[i], m_y[i], handle});
+		}
+	}
+
+	bool tower_archetype_t::launch(const blt::u32 index, const blt::vec2& target, projectile_pool_t& projectiles) const
+	{
+		const auto speed = m_stats.projectile_speed;
+		if (speed <= 0)
+			return false;
+		const blt::vec2 position{m_x[index], m_y[index]};
+		const auto offset = target - position;
+		const auto length = offset.magnitude();
+		const auto direction = length > 0 ? offset * (1.0f / length) : blt::vec2{1, 0};
+		// long enough to cross the whole range with some slack, the target keeps moving after the shot
+		const auto lifetime = std::sqrt(m_range_squared[index]) * PROJECTILE_RANGE_SLACK / speed;
+		// a full pool falls back to an instant hit so the tower's damage output doesn't depend on the pool size
+		return projectiles.spawn(projectile_t{position, direction * speed, lifetime, m_damage[index], PROJECTILE_RADIUS, m_damage_mask[index]});
+	}
+
+	void tower_archetype_t::write_instances(std::vector<sprite_instance_t>& instances, const blt::u32 texture) const
+	{
+		constexpr float size = 16;
+		for (blt::size_t i = 0; i < m_ids.size(); ++i)
+			instances.push_back(sprite_instance_t{m_x[i], m_y[i], size, texture, 0, 0.4f, 1, 1});
+	}
+
+	void tower_archetype_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		writer.write(m_ids);
+		writer.write(m_x);
+		writer.write(m_y);
+		writer.write(m_range_squared);
+		writer.write(m_cooldown);
+		writer.write(m_damage);
+		writer.write(m_damage_mask);
+	}
+
+	bool tower_archetype_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		reader.read(m_ids);
+		reader.read(m_x);
+		reader.read(m_y);
+		reader.read(m_range_squared);
+		reader.read(m_cooldown);
+		reader.read(m_damage);
+		reader.read(m_damage_mask);
+		m_coverage_first.clear();
+		m_coverage_count.clear();
+		m_coverage.clear();
+		const auto count = m_ids.size();
+		return reader.good() && m_x.size() == count && m_y.size() == count && m_range_squared.size() == count && m_cooldown.size() == count &&
+			m_damage.size() == count && m_damage_mask.size() == count;
+	}
+
+	tower_system_t::tower_system_t()
+	{
+		register_archetype(tower_id_t::BASIC, tower_stats_t{120, 0.5f, 1, 0, targeting_t::FIRST, 600});
+		register_archetype(tower_id_t::SNIPER, tower_stats_t{400, 2.0f, 5, static_cast<blt::u8>(damage_type_t::KISSES), targeting_t::STRONGEST, 0});
+		register_archetype(tower_id_t::LOVE, tower_stats_t{150, 1.0f, 2, static_cast<blt::u8>(damage_type_t::LOVE), targeting_t::CLOSEST, 400});
+	}
+
+	void tower_system_t::register_archetype(const tower_id_t type, const tower_stats_t& stats)
+	{
+		const auto index = static_cast<blt::u32>(type);
+		if (m_archetypes.size() <= index)
+			m_archetypes.resize(index + 1, tower_archetype_t{tower_stats_t{}});
+		m_archetypes[index] = tower_archetype_t{stats};
+	}
+
+	blt::u32 tower_system_t::place(const tower_id_t type, const blt::vec2& position)
+	{
+		// ids come from replays and text sources, an unknown one is ignored rather than trusted as an index
+		if (static_cast<blt::u32>(type) >= m_archetypes.size())
+			return NO_TOWER;
+		const auto id = m_next_id++;
+		m_archetypes[static_cast<blt::u32>(type)].add(id, position);
+		return id;
+	}
+
+	void tower_system_t::step(const float dt, map_t& map, std::vector<hit_t>& hits, projectile_pool_t& projectiles, event_bus_t* events)
+	{
+		for (auto& archetype : m_archetypes)
+		{
+			m_ready.clear();
+			archetype.tick_cooldowns(dt, m_ready);
+			if (!m_ready.empty())
+				archetype.fire(m_ready, map, hits, projectiles, events);
+		}
+	}
+
+	void tower_system_t::write_instances(std::vector<sprite_instance_t>& instances) const
+	{
+		for (const auto& archetype : m_archetypes)
+			archetype.write_instances(instances, m_texture);
+	}
+
+	void tower_system_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		writer.write(m_next_id);
+		for (const auto& archetype : m_archetypes)
+			archetype.write_snapshot(writer);
+	}
+
+	bool tower_system_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		reader.read(m_next_id);
+		blt::u64 tower_count = 0;
+		for (auto& archetype : m_archetypes)
+		{
+			if (!archetype.read_snapshot(reader))
+				return false;
+			tower_count += archetype.size();
+		}
+		// ids are handed out one per placement and towers are never removed, so the counter must match the towers restored
+		return reader.good() && tower_count == m_next_id;
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <waves.h>
+#include <algorithm>
+#include <cmath>
+
+namespace td
+{
+	void wave_scheduler_t::add_wave(const wave_t& wave)
+	{
+		// keep waves ordered by start so collect() can stop at the first wave which hasn't started
+		const auto it = std::upper_bound(m_waves.begin() + static_cast<std::ptrdiff_t>(m_next_wave), m_waves.end(), wave.start_time,
+										[](const float time, const wave_t& other) {
+											return time < other.start_time;
+										});
+		const auto index = it - m_waves.begin();
+		m_waves.insert(it, wave);
+		m_spawned.insert(m_spawned.begin() + index, 0);
+	}
+
+	void wave_scheduler_t::collect(const double time, std::vector<wave_spawn_t>& spawns)
+	{
+		for (auto i = m_next_wave; i < m_waves.size(); ++i)
+		{
+			const auto& wave = m_waves[i];
+			if (wave.start_time > time)
+				break;
+			// every spawn index with start_time + index * spacing <= time is due. Worked in double like the game clock, so spawn times keep
+			// their sub-tick precision however long the game has run, only the small ages are narrowed to float.
+			const auto start_time = static_cast<double>(wave.start_time);
+			const auto spacing = static_cast<double>(wave.spacing);
+			auto due = wave.count;
+			if (wave.spacing > 0)
+				due = std::min(wave.count, static_cast<blt::u32>(std::floor((time - start_time) / spacing)) + 1);
+			for (auto index = m_spawned[i]; index < due; ++index)
+				spawns.push_back(wave_spawn_t{wave.enemy, static_cast<float>(std::max(0.0, time - (start_time + static_cast<double>(index) * spacing)))});
+			m_spawned[i] = due;
+		}
+		while (m_next_wave < m_waves.size() && m_spawned[m_next_wave] == m_waves[m_next_wave].count)
+			++m_next_wave;
+	}
+
+	void wave_scheduler_t::write_snapshot(snapshot_writer_t& writer) const
+	{
+		writer.write(m_waves);
+		writer.write(m_spawned);
+		writer.write(static_cast<blt::u64>(m_next_wave));
+	}
+
+	void wave_scheduler_t::add_to_hash(fnv1a_t& hash) const
+	{
+		hash.add(m_waves);
+		hash.add(m_spawned);
+		hash.add(static_cast<blt::u64>(m_next_wave));
+	}
+
+	bool wave_scheduler_t::read_snapshot(snapshot_reader_t& reader)
+	{
+		blt::u64 next_wave = 0;
+		reader.read(m_waves);
+		reader.read(m_spawned);
+		reader.read(next_wave);
+		m_next_wave = static_cast<blt::size_t>(next_wave);
+		return reader.good() && m_spawned.size() == m_waves.size() && m_next_wave <= m_waves.size();
+	}
+
+	void wave_scheduler_t::clear()
+	{
+		m_waves.clear();
+		m_spawned.clear();
+		m_next_wave = 0;
+	}
+}
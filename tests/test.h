@@ -0,0 +1,53 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TD_TEST_H
+#define TD_TEST_H
+
+#include <blt/logging/logging.h>
+
+namespace td::test
+{
+	// checks failed so far, a test program returns it so CTest sees the failure
+	inline int failures = 0;
+
+	inline void check(const bool passed, const char* expression, const char* file, const int line)
+	{
+		if (passed)
+			return;
+		++failures;
+		BLT_ERROR("{}:{}: check failed: {}", file, line, expression);
+	}
+
+	// runs one test case, naming it in the output so a failed check can be traced back to its case
+	template <typename Func>
+	void run(const char* name, Func&& func)
+	{
+		const auto before = failures;
+		func();
+		if (failures == before)
+			BLT_INFO("{} passed", name);
+		else
+			BLT_ERROR("{} failed", name);
+	}
+}
+
+// keeps going after a failure, so one run reports every broken check
+#define TD_CHECK(expression) ::td::test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif //TD_TEST_H
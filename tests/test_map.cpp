@@ -0,0 +1,58 @@
+/*
+ *  Behaviour tests for map_t
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <map.h>
+
+namespace
+{
+	// every position must be the path point at its enemy's distance
+	void check_positions(const td::map_t& map)
+	{
+		const auto& positions = map.get_enemy_positions();
+		const auto& distances = map.get_enemies().get_distance_along_path();
+		TD_CHECK(positions.size() == distances.size());
+		for (blt::size_t i = 0; i < positions.size() && i < distances.size(); ++i)
+		{
+			const auto expected = map.get_point(distances[i]);
+			TD_CHECK(positions[i].x() == expected.x() && positions[i].y() == expected.y());
+		}
+	}
+}
+
+int main()
+{
+	td::test::run("apply_damage after spawn without a step", [] {
+		td::enemy_database_t database;
+		td::map_t map{td::make_default_path(), database};
+		map.spawn(td::enemy_id_t::TEST, 10);
+		map.spawn(td::enemy_id_t::TEST, 20);
+		map.step(0);
+		// spawned after the last step, so their positions haven't been computed yet
+		const auto splitter = map.spawn(td::enemy_id_t::TEST_SPLITTER, 30);
+		map.spawn(td::enemy_id_t::TEST, 40);
+		const auto killed = map.spawn(td::enemy_id_t::TEST, 50);
+		TD_CHECK(map.get_enemy_positions().size() == 2);
+
+		map.apply_damage({td::hit_t{killed, 100, 0}, td::hit_t{splitter, 100, 0}});
+		// four survivors plus the splitter's two children
+		TD_CHECK(map.get_enemies().size() == 5);
+		check_positions(map);
+	});
+
+	return td::test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*
+ *  Behaviour tests for the particle ring
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <particles.h>
+
+namespace
+{
+	// a motionless particle, x tells particles apart in the written instances
+	void spawn(td::particle_pool_t& pool, const float x, const float lifetime)
+	{
+		pool.spawn(blt::vec2{x, 0}, blt::vec2{0, 0}, lifetime, 1, 1, 1, 1);
+	}
+
+	std::vector<td::sprite_instance_t> instances_of(const td::particle_pool_t& pool)
+	{
+		std::vector<td::sprite_instance_t> instances;
+		pool.write_instances(instances);
+		return instances;
+	}
+}
+
+int main()
+{
+	td::test::run("full ring recycles its oldest particle", [] {
+		td::particle_pool_t pool{3};
+		for (const float x : {1.0f, 2.0f, 3.0f, 4.0f})
+			spawn(pool, x, 10);
+		TD_CHECK(pool.size() == 3);
+		const auto instances = instances_of(pool);
+		TD_CHECK(instances.size() == 3);
+		if (instances.size() == 3)
+		{
+			TD_CHECK(instances[0].x == 2);
+			TD_CHECK(instances[1].x == 3);
+			TD_CHECK(instances[2].x == 4);
+		}
+	});
+
+	td::test::run("tail only drops dead particles", [] {
+		td::particle_pool_t pool{4};
+		// the oldest particle outlives the one behind it, which has to wait for the tail
+		spawn(pool, 1, 10);
+		spawn(pool, 2, 0.5f);
+		pool.step(1);
+		TD_CHECK(pool.size() == 2);
+
+		pool.clear();
+		spawn(pool, 1, 0.5f);
+		spawn(pool, 2, 10);
+		pool.step(1);
+		TD_CHECK(pool.size() == 1);
+		const auto instances = instances_of(pool);
+		TD_CHECK(instances.size() == 1 && instances[0].x == 2);
+	});
+
+	td::test::run("write_instances skips a dead particle in the middle of the ring", [] {
+		td::particle_pool_t pool{4};
+		spawn(pool, 1, 10);
+		spawn(pool, 2, 0.5f);
+		spawn(pool, 3, 10);
+		pool.step(1);
+		TD_CHECK(pool.size() == 3);
+		const auto instances = instances_of(pool);
+		TD_CHECK(instances.size() == 2);
+		if (instances.size() == 2)
+		{
+			TD_CHECK(instances[0].x == 1);
+			TD_CHECK(instances[1].x == 3);
+		}
+	});
+
+	td::test::run("step and write_instances cover a wrapped ring", [] {
+		td::particle_pool_t pool{4};
+		// move the tail to index 2, so the next three particles land in slots 2, 3 and 0
+		spawn(pool, 0, 0.5f);
+		spawn(pool, 0, 0.5f);
+		pool.step(1);
+		TD_CHECK(pool.size() == 0);
+		pool.spawn(blt::vec2{1, 0}, blt::vec2{10, 0}, 10, 1, 1, 1, 1);
+		pool.spawn(blt::vec2{2, 0}, blt::vec2{10, 0}, 10, 1, 1, 1, 1);
+		pool.spawn(blt::vec2{3, 0}, blt::vec2{10, 0}, 10, 1, 1, 1, 1);
+		TD_CHECK(pool.size() == 3);
+		pool.step(0.1f);
+		const auto instances = instances_of(pool);
+		TD_CHECK(instances.size() == 3);
+		if (instances.size() == 3)
+		{
+			// every particle moved, the wrapped one in slot 0 included, and they come out oldest first
+			TD_CHECK(instances[0].x > 1 && instances[0].x < 2);
+			TD_CHECK(instances[1].x > 2 && instances[1].x < 3);
+			TD_CHECK(instances[2].x > 3 && instances[2].x < 4);
+		}
+	});
+
+	return td::test::failures == 0 ? 0 : 1;
+}
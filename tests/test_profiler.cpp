@@ -0,0 +1,86 @@
+/*
+ *  Profiler ring and zone merging tests
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <profiler.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	blt::size_t count_named(const char* name)
+	{
+		blt::size_t count = 0;
+		for (const auto& zone : td::profiler::get_stats())
+			count += std::strcmp(zone.name, name) == 0;
+		return count;
+	}
+}
+
+int main()
+{
+	td::test::run("zones with equal names at different addresses are merged", [] {
+		// arrays, unlike literals, are guaranteed distinct objects
+		static const char first[] = "merged zone";
+		static const char second[] = "merged zone";
+		TD_CHECK(static_cast<const void*>(first) != static_cast<const void*>(second));
+		td::profiler::record(first, 0, 1'000'000);
+		td::profiler::record(second, 0, 1'000'000);
+		td::profiler::end_frame();
+		TD_CHECK(count_named("merged zone") == 1);
+		for (const auto& zone : td::profiler::get_stats())
+		{
+			if (std::strcmp(zone.name, "merged zone") == 0)
+				TD_CHECK(zone.last_ms == 2);
+		}
+	});
+
+	td::test::run("readers never see a torn record from a wrapping ring", [] {
+		// every worker zone lasts exactly 1us, a record mixing two laps of the ring would not
+		std::atomic<bool> done{false};
+		std::thread worker{[&done] {
+			for (blt::u64 i = 0; i < td::profiler::ZONES_PER_THREAD * 20; ++i)
+				td::profiler::record("worker zone", i, i + 1000);
+			done = true;
+		}};
+		blt::size_t traces = 0;
+		bool torn = false;
+		while (!done || traces == 0)
+		{
+			td::profiler::end_frame();
+			TD_CHECK(td::profiler::write_chrome_trace("test_profiler.json"));
+			++traces;
+			std::ifstream trace{"test_profiler.json"};
+			std::string line;
+			while (std::getline(trace, line))
+			{
+				if (line.find("\"worker zone\"") != std::string::npos && line.find("\"dur\":1.000}") == std::string::npos)
+					torn = true;
+			}
+		}
+		worker.join();
+		TD_CHECK(!torn);
+		TD_CHECK(count_named("worker zone") == 1);
+	});
+
+	std::remove("test_profiler.json");
+	return td::test::failures == 0 ? 0 : 1;
+}
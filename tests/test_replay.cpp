@@ -0,0 +1,77 @@
+/*
+ *  Replay recording and verification tests
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <game.h>
+#include <cstdio>
+
+namespace
+{
+	// records a game with a wave and a tower, written to and read back from path
+	td::replay_t record(const std::string& path, const float speed_multiplier)
+	{
+		td::game_t game{td::make_default_path(), td::game_t::DEFAULT_TICK_LENGTH, 11};
+		game.get_map().set_speed_multiplier(speed_multiplier);
+		game.start_recording(30);
+		game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST_SPLITTER, 30, 0.2f, 0}});
+		td::input_t input{0, td::input_type_t::PLACE_TOWER};
+		input.tower = td::tower_placement_t{td::tower_id_t::BASIC, 400, 350};
+		game.queue_input(input);
+		for (int i = 0; i < 900; ++i)
+			game.step(game.get_tick_length());
+		TD_CHECK(game.get_replay().write(path));
+		td::replay_t replay;
+		TD_CHECK(replay.read(path));
+		return replay;
+	}
+}
+
+int main()
+{
+	td::test::run("replay re-simulates to the recorded hashes", [] {
+		const auto replay = record("test_replay.bin", td::PATH_SPEED_MULTIPLIER);
+		TD_CHECK(!replay.checkpoints.empty());
+		TD_CHECK(td::play_replay(replay, td::make_default_path()).matched());
+	});
+
+	td::test::run("replay re-simulates with the recorded speed multiplier", [] {
+		const auto replay = record("test_replay.bin", 3);
+		TD_CHECK(replay.speed_multiplier == 3);
+		TD_CHECK(td::play_replay(replay, td::make_default_path()).matched());
+	});
+
+	td::test::run("replay from a different enemy database is rejected", [] {
+		auto replay = record("test_replay.bin", td::PATH_SPEED_MULTIPLIER);
+		replay.database_hash ^= 1;
+		const auto result = td::play_replay(replay, td::make_default_path());
+		TD_CHECK(!result.database_matched);
+		TD_CHECK(!result.matched());
+	});
+
+	td::test::run("replay naming an unknown tower is rejected on read", [] {
+		auto replay = record("test_replay.bin", td::PATH_SPEED_MULTIPLIER);
+		td::input_t input{0, td::input_type_t::PLACE_TOWER};
+		input.tower = td::tower_placement_t{static_cast<td::tower_id_t>(td::TOWER_ID_COUNT), 0, 0};
+		replay.inputs.push_back(input);
+		TD_CHECK(replay.write("test_replay.bin"));
+		td::replay_t read;
+		TD_CHECK(!read.read("test_replay.bin"));
+	});
+
+	std::remove("test_replay.bin");
+	return td::test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+ *  Snapshot determinism and rejection tests
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <game.h>
+
+namespace
+{
+	constexpr blt::u64 SEED = 7;
+
+	// waves, towers of every archetype and projectiles in flight, so a snapshot taken mid-game has every system in use
+	void start_game(td::game_t& game)
+	{
+		game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST, 60, 0.25f, 0}});
+		game.queue_input(td::input_t{0, td::input_type_t::START_WAVE, td::wave_t{td::enemy_id_t::TEST_SPLITTER, 20, 0.5f, 4}});
+		for (const auto& tower : {td::tower_placement_t{td::tower_id_t::BASIC, 400, 350}, td::tower_placement_t{td::tower_id_t::SNIPER, 500, 150},
+									td::tower_placement_t{td::tower_id_t::LOVE, 600, 350}})
+		{
+			td::input_t input{0, td::input_type_t::PLACE_TOWER};
+			input.tower = tower;
+			game.queue_input(input);
+		}
+	}
+
+	void step(td::game_t& game, const blt::u64 ticks)
+	{
+		for (blt::u64 i = 0; i < ticks; ++i)
+			game.step(game.get_tick_length());
+	}
+
+	std::vector<td::path_segment_t> make_other_path()
+	{
+		return {td::path_segment_t{blt::gfx::curve2d_t{blt::vec2{0, 0}, blt::vec2{50, 100}, blt::vec2{100, 0}}}};
+	}
+
+	// a restore which fails its header check must leave the target exactly as it was
+	void check_rejected(td::game_t& target, const std::vector<blt::u8>& snapshot)
+	{
+		step(target, 10);
+		const auto tick = target.get_tick();
+		const auto hash = target.compute_state_hash();
+		TD_CHECK(!target.restore_snapshot(snapshot));
+		TD_CHECK(target.get_tick() == tick);
+		TD_CHECK(target.compute_state_hash() == hash);
+	}
+}
+
+int main()
+{
+	td::test::run("restored game stays in step with the original", [] {
+		td::game_t original{td::make_default_path(), td::game_t::DEFAULT_TICK_LENGTH, SEED};
+		start_game(original);
+		step(original, 600);
+		TD_CHECK(original.get_map().get_enemies().size() > 0);
+
+		std::vector<blt::u8> snapshot;
+		original.save_snapshot(snapshot);
+		td::game_t fork{td::make_default_path(), td::game_t::DEFAULT_TICK_LENGTH, SEED};
+		TD_CHECK(fork.restore_snapshot(snapshot));
+		TD_CHECK(fork.get_tick() == original.get_tick());
+		TD_CHECK(fork.compute_state_hash() == original.compute_state_hash());
+
+		for (int round = 0; round < 20; ++round)
+		{
+			step(original, 60);
+			step(fork, 60);
+			TD_CHECK(fork.compute_state_hash() == original.compute_state_hash());
+		}
+	});
+
+	td::test::run("snapshot from a different path is rejected", [] {
+		td::game_t source{td::make_default_path()};
+		start_game(source);
+		step(source, 120);
+		std::vector<blt::u8> snapshot;
+		source.save_snapshot(snapshot);
+
+		td::game_t target{make_other_path()};
+		start_game(target);
+		check_rejected(target, snapshot);
+	});
+
+	td::test::run("snapshot from a different enemy database is rejected", [] {
+		td::game_t source{td::make_default_path()};
+		start_game(source);
+		step(source, 120);
+		std::vector<blt::u8> snapshot;
+		source.save_snapshot(snapshot);
+
+		td::game_t target{td::make_default_path()};
+		target.get_database().add_enemy(td::enemy_id_t::TEST, td::enemy_t{"test", {}}.set_health(5).set_speed(10));
+		start_game(target);
+		check_rejected(target, snapshot);
+	});
+
+	td::test::run("speed multiplier travels with the snapshot", [] {
+		td::game_t original{td::make_default_path(), td::game_t::DEFAULT_TICK_LENGTH, SEED};
+		original.get_map().set_speed_multiplier(3);
+		start_game(original);
+		step(original, 300);
+		std::vector<blt::u8> snapshot;
+		original.save_snapshot(snapshot);
+
+		td::game_t fork{td::make_default_path(), td::game_t::DEFAULT_TICK_LENGTH, SEED};
+		TD_CHECK(fork.restore_snapshot(snapshot));
+		TD_CHECK(fork.get_map().get_speed_multiplier() == 3);
+		// the second wave spawns after the restore, at the snapshot's speed
+		step(original, 600);
+		step(fork, 600);
+		TD_CHECK(fork.compute_state_hash() == original.compute_state_hash());
+	});
+
+	return td::test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+/*
+ *  Wave scheduler timing tests
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <test.h>
+#include <waves.h>
+#include <cmath>
+
+int main()
+{
+	td::test::run("spawns keep their timing hours into a game", [] {
+		// five hours in, a float clock only resolves about 2ms
+		constexpr double start = 5 * 60 * 60;
+		td::wave_scheduler_t waves;
+		waves.add_wave(td::wave_t{td::enemy_id_t::TEST, 20, 0.01f, static_cast<float>(start)});
+		std::vector<td::wave_spawn_t> spawns;
+		const double time = start + 0.1055;
+		waves.collect(time, spawns);
+		TD_CHECK(spawns.size() == 11);
+		for (blt::size_t i = 0; i < spawns.size(); ++i)
+		{
+			const auto expected = time - (start + static_cast<double>(i) * static_cast<double>(0.01f));
+			TD_CHECK(std::abs(static_cast<double>(spawns[i].age) - expected) < 1e-6);
+		}
+	});
+
+	td::test::run("every spawn is handed out exactly once", [] {
+		td::wave_scheduler_t waves;
+		waves.add_wave(td::wave_t{td::enemy_id_t::TEST, 50, 0.1f, 1});
+		waves.add_wave(td::wave_t{td::enemy_id_t::TEST_SPLITTER, 10, 0, 2});
+		std::vector<td::wave_spawn_t> spawns;
+		for (int tick = 0; tick < 600 && !waves.is_finished(); ++tick)
+			waves.collect(tick / 60.0, spawns);
+		TD_CHECK(waves.is_finished());
+		TD_CHECK(spawns.size() == 60);
+	});
+
+	return td::test::failures == 0 ? 0 : 1;
+}